@@ -2,7 +2,6 @@
 #include <iostream>
 #include <cassert>
 #include <string_view>
-#include <unordered_map>
 
 /*
  * there are tow methods to obtain data from node object
@@ -10,12 +9,16 @@
  *      but the Type must be same as the node's built-in data 
  * for node.as<Type>(), it may (without errors) return a copy of data
  *      it only requires the data can be converted to Type data
+ * strings and containers are stored as std::pmr types (node::str_t,
+ *      node::arr_t and node::obj_t), get<std::string>() is accepted but
+ *      returns a std::pmr::string&, which cannot bind to std::string&
+ *      so use auto& for the reference, or as<std::string>() for a copy
  */
 
 int main()
 {
     namespace json = mini_json;
-    using Obj = std::unordered_map<std::string, json::node>;
+    using Obj = json::node::obj_t;
 
     // create json object
     std::string cont = "{\"name\": \"arthur\", \"age\": 19}";
@@ -32,9 +35,14 @@ int main()
 
         // a string_view object is fast and safe
         auto  name = root.at("name").as<std::string_view>();
+        // a std::string is a copy, get<std::string>() is a std::pmr::string&
+        std::string copy = root.at("name").as<std::string>();
+        auto const& stored = root.at("name").get<std::string>();
+        // and the two compare through a std::string_view
+        assert(std::string_view(stored) == copy);
 
-        // the type of number data in a node object is double
-        // but it can be converted to int data from as<int> func
+        // integers are stored as int64_t (uint64_t if too large)
+        // and other numbers as double, as<int> converts from either
         int   age  = root.at("age").as<int>();
         std::cout << "name: " << name << std::endl;
         std::cout << "age : " << age << std::endl;
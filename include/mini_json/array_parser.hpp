@@ -0,0 +1,152 @@
+#pragma once
+#include "json.hpp"
+#include "pool.hpp"
+#include "scan.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mini_json {
+
+/**
+ * array_parser parses one document whose root is a large array
+ * on a pool of worker threads, its elements are split by a quick scan,
+ * parsed apart by the workers and spliced into one array in order
+ * any other root, and any input when there is a single worker,
+ * is parsed by json as a whole, as splitting would only cost time
+ */
+class array_parser {
+
+public:
+    using error_code = json::error_code;
+
+private:
+    using document = detail::parse_pool::document;
+
+    detail::parse_pool pool;
+
+    /**
+     * collect the next elements of an array, up to batch_size of them
+     * only quotes, escapes and brackets are looked at, so the elements
+     * themselves are checked by the workers
+     * it is left at the next element, or past the closing ']'
+     */
+    bool split(char const*& it, char const* end, std::size_t& index, std::vector<document>& docs, bool& closed)
+    {
+        char const* first = it;
+        std::size_t depth = 1;
+
+        char const* cur = it;
+        while (docs.size() < detail::parse_pool::batch_size) {
+            cur = detail::next_structural(cur, end);
+            if (cur == end)
+                return pool.report(error_code::miss_separator, index);
+
+            char const* at = cur++;
+            switch (*at) {
+            case '\"':
+                cur = detail::skip_string(cur, end);
+                if (!cur)
+                    return pool.report(error_code::invalid_value, index);
+                break;
+
+            case '[':
+            case '{':
+                ++depth;
+                break;
+
+            case ']':
+            case '}':
+                if (--depth != 0)
+                    break;
+
+                if (*at != ']')
+                    return pool.report(error_code::miss_separator, index);
+
+                // the only element of [ ] is no element at all
+                if (index != 0 || detail::skip_ws(first, at) != at)
+                    docs.push_back({ std::string_view(first, at - first), index++ });
+                it = cur;
+                closed = true;
+                return true;
+
+            case ',':
+                if (depth == 1) {
+                    docs.push_back({ std::string_view(first, at - first), index++ });
+                    first = cur;
+                }
+                break;
+            }
+        }
+
+        it = first;
+        return true;
+    }
+
+public:
+    /**
+     * threads is the number of workers, zero means one per core
+     */
+    explicit array_parser(std::size_t threads = 0)
+        : pool(threads ? threads : std::max(1u, std::thread::hardware_concurrency()))
+    {
+    }
+
+    /**
+     * parse input into out, which is only assigned on success
+     */
+    bool parse(std::string_view input, node& out)
+    {
+        char const* it = input.data();
+        char const* end = it + input.size();
+
+        it = detail::skip_ws(it, end);
+        if (pool.size() == 1 || it == end || *it != '[') {
+            json& parser = pool.front();
+            parser.reset_view(input);
+            if (node* got = parser.parse(); got) {
+                out = std::move(*got);
+                return pool.report(error_code::non, 0);
+            }
+
+            return pool.report(parser.errp(), 0);
+        }
+
+        node::arr_t arr;
+        auto splice = [&arr](node& elem) { arr.push_back(std::move(elem)); };
+        auto next = [&, index = std::size_t(0)](std::vector<document>& docs, bool& last) mutable {
+            return split(it, end, index, docs, last);
+        };
+
+        ++it;
+        if (!pool.run(next, splice))
+            return false;
+
+        if (detail::skip_ws(it, end) != end)
+            return pool.report(error_code::root_singular, 0);
+
+        out = std::move(arr);
+        return true;
+    }
+
+    error_code errp() const noexcept
+    {
+        return pool.errp();
+    }
+
+    // index of the invalid element, zero when the input was parsed as a whole
+    std::size_t errindex() const noexcept
+    {
+        return pool.errpos();
+    }
+
+    std::size_t threads() const noexcept
+    {
+        return pool.size();
+    }
+};
+
+}; // namespace mini_json
@@ -0,0 +1,107 @@
+#pragma once
+#include "builder.hpp"
+#include "node.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace mini_json::detail {
+
+// big-endian integers, as both msgpack and cbor store them
+template <typename T>
+inline T load_be(char const* src) noexcept
+{
+    T val = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+        val = T(val << 8) | static_cast<unsigned char>(src[i]);
+    return val;
+}
+
+template <typename T>
+inline char* store_be(char* out, T val) noexcept
+{
+    for (std::size_t i = sizeof(T); i-- > 0; val = T(val >> 8))
+        out[i] = static_cast<char>(val & 0xFF);
+    return out + sizeof(T);
+}
+
+// little-endian integers, as snapshot stores them
+template <typename T>
+inline T load_le(char const* src) noexcept
+{
+    T val = 0;
+    for (std::size_t i = sizeof(T); i-- > 0;)
+        val = T(val << 8) | static_cast<unsigned char>(src[i]);
+    return val;
+}
+
+template <typename T>
+inline char* store_le(char* out, T val) noexcept
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i, val = T(val >> 8))
+        out[i] = static_cast<char>(val & 0xFF);
+    return out + sizeof(T);
+}
+
+inline double load_double(char const* src) noexcept
+{
+    auto bits = load_be<std::uint64_t>(src);
+    double val;
+    std::memcpy(&val, &bits, sizeof val);
+    return val;
+}
+
+inline float load_float(char const* src) noexcept
+{
+    auto bits = load_be<std::uint32_t>(src);
+    float val;
+    std::memcpy(&val, &bits, sizeof val);
+    return val;
+}
+
+// a half precision float, which only cbor has
+inline double load_half(char const* src) noexcept
+{
+    auto bits = load_be<std::uint16_t>(src);
+    int exp = (bits >> 10) & 0x1F;
+    int mant = bits & 0x3FF;
+
+    double val;
+    if (exp == 0)
+        val = std::ldexp(mant, -24);
+    else if (exp != 31)
+        val = std::ldexp(mant + 1024, exp - 25);
+    else
+        val = mant ? std::numeric_limits<double>::quiet_NaN() : std::numeric_limits<double>::infinity();
+
+    return bits & 0x8000 ? -val : val;
+}
+
+inline char* store_double(char* out, double val) noexcept
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &val, sizeof bits);
+    return store_be(out, bits);
+}
+
+template <typename Handler, typename = void>
+struct has_reserve : std::false_type { };
+
+template <typename Handler>
+struct has_reserve<Handler, std::void_t<decltype(std::declval<Handler&>().reserve(std::size_t()))>>
+    : std::true_type { };
+
+// tell a handler that wants it how many elements or members follow
+template <typename Handler>
+inline void reserve(Handler& handler, std::size_t count)
+{
+    if constexpr (has_reserve<Handler>::value)
+        handler.reserve(count);
+}
+
+}; // namespace mini_json::detail
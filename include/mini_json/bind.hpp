@@ -0,0 +1,571 @@
+#pragma once
+#include "../mini_mpf/key_map.hpp"
+#include "../mini_mpf/type_array.hpp"
+#include "json.hpp"
+#include "node.hpp"
+#include "number.hpp"
+#include "scan.hpp"
+#include "sink.hpp"
+#include "string.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mini_json {
+
+/**
+ * binding lists the data members of a struct for binder
+ * it is specialized by MINI_JSON_BIND rather than written by hand
+ *     members    a mini_mpf::type_array with a field for every member
+ *     names      their keys, in the same order
+ * a type without a binding has no members and is not bound
+ */
+template <typename T>
+struct binding {
+};
+
+/**
+ * field describes one data member by its member pointer
+ */
+template <auto Ptr>
+struct field;
+
+template <typename Class, typename T, T Class::*Ptr>
+struct field<Ptr> {
+    using class_type = Class;
+    using value_type = T;
+
+    static T& get(Class& obj) noexcept
+    {
+        return obj.*Ptr;
+    }
+
+    static T const& get(Class const& obj) noexcept
+    {
+        return obj.*Ptr;
+    }
+};
+
+namespace detail {
+
+template <typename T, typename = void>
+struct is_bound : std::false_type { };
+
+template <typename T>
+struct is_bound<T, std::void_t<typename binding<T>::members>> : std::true_type { };
+
+// the perfect hash over the names of a binding, built once at compile time
+template <typename T>
+inline constexpr mini_mpf::key_map<std::size(binding<T>::names)> keys_of { binding<T>::names };
+
+template <typename T>
+struct is_vector : std::false_type { };
+
+template <typename T, typename Alloc>
+struct is_vector<std::vector<T, Alloc>> : std::true_type { };
+
+template <typename T>
+struct is_optional : std::false_type { };
+
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type { };
+
+// std::map, std::unordered_map and the like, keyed by std::string
+template <typename T, typename = void>
+struct is_string_map : std::false_type { };
+
+template <typename T>
+struct is_string_map<T, std::void_t<typename T::key_type, typename T::mapped_type>>
+    : std::is_same<typename T::key_type, std::string> { };
+
+}; // namespace detail
+
+/**
+ * binder reads json text straight into bound structs and writes them
+ * back, without building a node in between
+ * it handles bool, arithmetic types, std::string, std::optional,
+ * std::vector, maps keyed by std::string and structs with a binding
+ * keys are matched by trying the member after the last one first, so
+ * members in declaration order are found with one comparison, and then
+ * by a mini_mpf::key_map over the names, the values of unknown keys are
+ * checked like json does but not stored, members missing from the input
+ * are left as they are, and a repeated key keeps its first value
+ * an integer member takes a number with a fraction like node::as does,
+ * but a number that does not fit its member fails with invalid_value
+ */
+class binder {
+
+public:
+    using error_code = json::error_code;
+
+private:
+    constexpr static std::size_t npos = std::size_t(-1);
+
+    char const* it = nullptr;
+    char const* end = nullptr;
+    // a key with escapes, or a skipped string, is decoded here
+    std::string key_buf;
+    error_code err = error_code::non;
+
+    bool fail(error_code code) noexcept
+    {
+        err = code;
+        return false;
+    }
+
+    char peek() noexcept
+    {
+        it = detail::skip_ws(it, end);
+        return it == end ? '\0' : *it;
+    }
+
+    bool literal(char const* lit, std::size_t len) noexcept
+    {
+        if (std::size_t(end - it) < len || std::memcmp(it, lit, len) != 0)
+            return fail(error_code::invalid_value);
+        it += len;
+        return true;
+    }
+
+    template <typename T>
+    bool read_number(T& out)
+    {
+        detail::number_literal num;
+        if (!detail::scan_number(it, end, num))
+            return fail(error_code::invalid_value);
+        it = num.end;
+
+        node::int_t ival = 0;
+        node::uint_t uval = 0;
+        node::num_t val = 0;
+
+        if constexpr (std::is_floating_point_v<T>) {
+            if (!detail::to_double(num, val))
+                return fail(error_code::invalid_value);
+
+            // a float has less range than the double read, what would round to inf does not fit
+            if constexpr (std::numeric_limits<T>::max_exponent < std::numeric_limits<double>::max_exponent) {
+                using limits = std::numeric_limits<T>;
+                double half_ulp = std::ldexp(1.0, limits::max_exponent - limits::digits - 1);
+                if (std::fabs(val) >= double(limits::max()) + half_ulp)
+                    return fail(error_code::invalid_value);
+            }
+
+            out = static_cast<T>(val);
+            return true;
+        } else {
+            using limits = std::numeric_limits<T>;
+
+            if (detail::to_int(num, ival)) {
+                if (ival < 0 ? ival < node::int_t(limits::min()) : node::uint_t(ival) > node::uint_t(limits::max()))
+                    return fail(error_code::invalid_value);
+                out = static_cast<T>(ival);
+            } else if (detail::to_uint(num, uval)) {
+                if (uval > node::uint_t(limits::max()))
+                    return fail(error_code::invalid_value);
+                out = static_cast<T>(uval);
+            } else if (detail::to_double(num, val) && val >= double(limits::min()) && val < double(limits::max()) + 1.0) {
+                out = static_cast<T>(val);
+            } else {
+                return fail(error_code::invalid_value);
+            }
+            return true;
+        }
+    }
+
+    template <typename Str>
+    bool read_string(Str& out)
+    {
+        if (peek() != '\"')
+            return fail(error_code::invalid_value);
+
+        ++it;
+        switch (detail::unescape(it, end, out)) {
+        case detail::string_error::non:
+            return true;
+        case detail::string_error::invalid_escape:
+            return fail(error_code::invalid_escape);
+        default:
+            return fail(error_code::invalid_value);
+        }
+    }
+
+    /**
+     * read the key of a member and the colon after it
+     * a key without escapes refers to the input
+     */
+    bool read_key(std::string_view& key)
+    {
+        if (peek() != '\"')
+            return fail(error_code::invalid_key);
+
+        char const* st = ++it;
+        char const* run = detail::next_quote(st, end);
+
+        if (run != end && *run == '\"') {
+            key = std::string_view(st, run - st);
+            it = run + 1;
+        } else {
+            it = st;
+            if (detail::unescape(it, end, key_buf) != detail::string_error::non)
+                return fail(error_code::invalid_key);
+            key = key_buf;
+        }
+
+        if (peek() != ':')
+            return fail(error_code::miss_separator);
+        ++it;
+        return true;
+    }
+
+    /**
+     * walk the members of an object, calling member(key) for each one
+     * with the value right after it
+     */
+    template <typename Member>
+    bool read_members(Member&& member)
+    {
+        if (peek() != '{')
+            return fail(error_code::invalid_value);
+        ++it;
+
+        if (peek() == '}') {
+            ++it;
+            return true;
+        }
+
+        while (true) {
+            std::string_view key;
+            if (!read_key(key) || !member(key))
+                return false;
+
+            switch (peek()) {
+            case ',':
+                ++it;
+                break;
+            case '}':
+                ++it;
+                return true;
+            default:
+                return fail(error_code::miss_separator);
+            }
+        }
+    }
+
+    // read past a value that is not stored, checking it on the way
+    bool skip()
+    {
+        switch (peek()) {
+        case 'n':
+            return literal("null", 4);
+        case 't':
+            return literal("true", 4);
+        case 'f':
+            return literal("false", 5);
+        case '\"':
+            return read_string(key_buf);
+        case '{':
+            return read_members([this](std::string_view) { return skip(); });
+        case '[':
+            ++it;
+            if (peek() == ']') {
+                ++it;
+                return true;
+            }
+
+            while (true) {
+                if (!skip())
+                    return false;
+
+                switch (peek()) {
+                case ',':
+                    ++it;
+                    break;
+                case ']':
+                    ++it;
+                    return true;
+                default:
+                    return fail(error_code::miss_separator);
+                }
+            }
+        default: {
+            detail::number_literal num;
+            if (it == end || !(*it == '-' || detail::is_digit(*it)))
+                return fail(error_code::expect_value);
+            if (!detail::scan_number(it, end, num))
+                return fail(error_code::invalid_value);
+            it = num.end;
+            return true;
+        }
+        }
+    }
+
+    // the position of key in the names of T, trying hint first
+    template <typename T>
+    static std::size_t match(std::string_view key, std::size_t hint) noexcept
+    {
+        constexpr auto& names = binding<T>::names;
+
+        if (hint < std::size(names) && names[hint] == key)
+            return hint;
+        return detail::keys_of<T>.find(key);
+    }
+
+    template <typename T, std::size_t... Index>
+    bool read_field(std::size_t idx, T& out, std::index_sequence<Index...>)
+    {
+        using members = typename binding<T>::members;
+
+        bool ret = false;
+        ((idx == Index && (ret = read_value(members::template at<Index>::get(out)), true)) || ...);
+        return ret;
+    }
+
+    template <typename T>
+    bool read_value(T& out)
+    {
+        if constexpr (detail::is_bound<T>::value) {
+            using members = typename binding<T>::members;
+            std::size_t hint = 0;
+            bool seen[members::len()] = {};
+
+            return read_members([&](std::string_view key) {
+                std::size_t idx = match<T>(key, hint);
+                if (idx == npos || seen[idx])
+                    return skip();
+
+                hint = idx + 1;
+                seen[idx] = true;
+                return read_field(idx, out, std::make_index_sequence<members::len()>());
+            });
+        } else if constexpr (detail::is_optional<T>::value) {
+            if (peek() == 'n') {
+                out.reset();
+                return literal("null", 4);
+            }
+            return read_value(out.emplace());
+        } else if constexpr (std::is_same_v<T, bool>) {
+            switch (peek()) {
+            case 't':
+                out = true;
+                return literal("true", 4);
+            case 'f':
+                out = false;
+                return literal("false", 5);
+            default:
+                return fail(error_code::invalid_value);
+            }
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            if (peek() != '-' && !detail::is_digit(peek()))
+                return fail(error_code::invalid_value);
+            return read_number(out);
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            return read_string(out);
+        } else if constexpr (detail::is_vector<T>::value) {
+            if (peek() != '[')
+                return fail(error_code::invalid_value);
+            ++it;
+
+            out.clear();
+            if (peek() == ']') {
+                ++it;
+                return true;
+            }
+
+            while (true) {
+                if (!read_value(out.emplace_back()))
+                    return false;
+
+                switch (peek()) {
+                case ',':
+                    ++it;
+                    break;
+                case ']':
+                    ++it;
+                    return true;
+                default:
+                    return fail(error_code::miss_separator);
+                }
+            }
+        } else if constexpr (detail::is_string_map<T>::value) {
+            out.clear();
+            return read_members([&](std::string_view key) {
+                auto [pos, fresh] = out.try_emplace(std::string(key));
+                return fresh ? read_value(pos->second) : skip();
+            });
+        } else {
+            static_assert(detail::is_bound<T>::value, "the given type cannot be bound to json");
+            return false;
+        }
+    }
+
+    template <typename Out, typename T>
+    static void write_value(Out& out, T const& val);
+
+    // writes the member Field of a struct, after a separator unless it is the first
+    template <typename Field, std::size_t Index>
+    struct write_field {
+        template <typename Out>
+        void operator()(Out& out, typename Field::class_type const& obj) const
+        {
+            constexpr auto name = binding<typename Field::class_type>::names[Index];
+            if constexpr (Index != 0)
+                out.append(", ", 2);
+            detail::escape(out, name);
+            out.append(": ", 2);
+            write_value(out, Field::get(obj));
+        }
+    };
+
+public:
+    /**
+     * read input, which must hold exactly one value, into out
+     * out is left partly filled when reading fails
+     */
+    template <typename T>
+    bool read(std::string_view input, T& out)
+    {
+        it = input.data();
+        end = it + input.size();
+        err = error_code::non;
+
+        if (!read_value(out))
+            return false;
+
+        peek();
+        return it == end || fail(error_code::root_singular);
+    }
+
+    /**
+     * write val to sink in the same layout as json::str
+     */
+    template <typename T, typename Sink>
+    bool write(T const& val, Sink& sink)
+    {
+        err = error_code::non;
+        detail::writer<Sink> out(sink);
+        write_value(out, val);
+        return out.flush() || fail(error_code::write_failed);
+    }
+
+    template <typename T>
+    std::string write(T const& val)
+    {
+        std::string ret;
+        string_sink sink(ret);
+        write(val, sink);
+        return ret;
+    }
+
+    error_code errp() const noexcept
+    {
+        return err;
+    }
+};
+
+template <typename Out, typename T>
+inline void binder::write_value(Out& out, T const& val)
+{
+    if constexpr (detail::is_bound<T>::value) {
+        out.put('{');
+        binding<T>::members::template for_each<write_field>(out, val);
+        out.put('}');
+    } else if constexpr (detail::is_optional<T>::value) {
+        if (val)
+            write_value(out, *val);
+        else
+            out.append("null", 4);
+    } else if constexpr (std::is_same_v<T, bool>) {
+        val ? out.append("true", 4) : out.append("false", 5);
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        char* first = out.reserve(detail::max_number_len);
+        out.commit(detail::format_number(first, val));
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        detail::escape(out, val);
+    } else if constexpr (detail::is_vector<T>::value) {
+        out.put('[');
+        for (auto first = val.begin(); first != val.end(); ++first) {
+            if (first != val.begin())
+                out.append(", ", 2);
+            write_value(out, *first);
+        }
+        out.put(']');
+    } else if constexpr (detail::is_string_map<T>::value) {
+        out.put('{');
+        for (auto first = val.begin(); first != val.end(); ++first) {
+            if (first != val.begin())
+                out.append(", ", 2);
+            detail::escape(out, first->first);
+            out.append(": ", 2);
+            write_value(out, first->second);
+        }
+        out.put('}');
+    } else {
+        static_assert(detail::is_bound<T>::value, "the given type cannot be bound to json");
+    }
+}
+
+}; // namespace mini_json
+
+// expand f(t, x) for every x, separated by commas
+#define MINI_JSON_EXPAND(x) x
+#define MINI_JSON_EACH_1(f, t, x) f(t, x)
+#define MINI_JSON_EACH_2(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_1(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_3(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_2(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_4(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_3(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_5(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_4(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_6(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_5(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_7(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_6(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_8(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_7(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_9(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_8(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_10(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_9(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_11(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_10(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_12(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_11(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_13(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_12(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_14(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_13(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_15(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_14(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_16(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_15(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_17(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_16(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_18(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_17(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_19(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_18(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_20(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_19(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_21(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_20(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_22(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_21(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_23(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_22(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_24(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_23(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_25(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_24(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_26(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_25(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_27(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_26(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_28(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_27(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_29(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_28(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_30(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_29(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_31(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_30(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_32(f, t, x, ...) f(t, x), MINI_JSON_EXPAND(MINI_JSON_EACH_31(f, t, __VA_ARGS__))
+#define MINI_JSON_EACH_PICK(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define MINI_JSON_FOR_EACH(f, t, ...) \
+    MINI_JSON_EXPAND(MINI_JSON_EACH_PICK(__VA_ARGS__, MINI_JSON_EACH_32, MINI_JSON_EACH_31, MINI_JSON_EACH_30, MINI_JSON_EACH_29, MINI_JSON_EACH_28, MINI_JSON_EACH_27, MINI_JSON_EACH_26, MINI_JSON_EACH_25, MINI_JSON_EACH_24, MINI_JSON_EACH_23, MINI_JSON_EACH_22, MINI_JSON_EACH_21, MINI_JSON_EACH_20, MINI_JSON_EACH_19, MINI_JSON_EACH_18, MINI_JSON_EACH_17, MINI_JSON_EACH_16, MINI_JSON_EACH_15, MINI_JSON_EACH_14, MINI_JSON_EACH_13, MINI_JSON_EACH_12, MINI_JSON_EACH_11, MINI_JSON_EACH_10, MINI_JSON_EACH_9, MINI_JSON_EACH_8, MINI_JSON_EACH_7, MINI_JSON_EACH_6, MINI_JSON_EACH_5, MINI_JSON_EACH_4, MINI_JSON_EACH_3, MINI_JSON_EACH_2, MINI_JSON_EACH_1)(f, t, __VA_ARGS__))
+
+/**
+ * MINI_JSON_BIND(type, members...) binds the listed data members of type,
+ * whose keys are the member names, it must be used at global scope
+ *     struct point { int x; int y; };
+ *     MINI_JSON_BIND(point, x, y)
+ * up to 32 members can be listed
+ */
+#define MINI_JSON_FIELD(type, member) ::mini_json::field<&type::member>
+#define MINI_JSON_NAME(type, member) #member
+
+#define MINI_JSON_BIND(type, ...)                                                                        \
+    template <>                                                                                          \
+    struct mini_json::binding<type> {                                                                    \
+        using members = ::mini_mpf::type_array<MINI_JSON_FOR_EACH(MINI_JSON_FIELD, type, __VA_ARGS__)>; \
+        constexpr static std::string_view names[] = { MINI_JSON_FOR_EACH(MINI_JSON_NAME, type, __VA_ARGS__) }; \
+    };
@@ -0,0 +1,132 @@
+#pragma once
+#include "key.hpp"
+#include "node.hpp"
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+
+namespace mini_json::detail {
+
+/**
+ * node_builder is a handler that builds a node from parsing events
+ * json, msgpack and cbor all make their trees with it
+ * containers and strings are allocated from resource, keys are interned
+ * in keys when one is given, and strings lying inside insitu are kept
+ * as views into it instead of being copied
+ * a repeated key keeps its first value
+ */
+class node_builder {
+
+private:
+    struct level {
+        node::arr_t* arr;
+        node::obj_t* obj;
+    };
+
+    node& root;
+    std::pmr::memory_resource* resource;
+    key_pool* keys;
+    std::string_view insitu;
+    std::vector<level> stack;
+    // the node the value after the last key goes to
+    node* member = nullptr;
+    // the values of repeated keys go here and are dropped
+    std::deque<node> discard;
+
+    node& slot()
+    {
+        if (stack.empty())
+            return root;
+
+        auto& top = stack.back();
+        return top.arr ? top.arr->emplace_back() : *member;
+    }
+
+    template <typename T>
+    bool put(T&& val)
+    {
+        slot().assign(std::forward<T>(val));
+        return true;
+    }
+
+    bool in_place(std::string_view val) const noexcept
+    {
+        std::less_equal<char const*> before;
+        return !insitu.empty() && before(insitu.data(), val.data()) && before(val.data() + val.size(), insitu.data() + insitu.size());
+    }
+
+public:
+    explicit node_builder(node& root, std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+        key_pool* keys = nullptr, std::string_view insitu = {})
+        : root(root)
+        , resource(resource)
+        , keys(keys)
+        , insitu(insitu)
+    {
+    }
+
+    bool null() { return put(nullptr); }
+    bool boolean(bool val) { return put(val); }
+    bool integer(node::int_t val) { return put(val); }
+    bool uinteger(node::uint_t val) { return put(val); }
+    bool number(node::num_t val) { return put(val); }
+
+    bool string(std::string_view val)
+    {
+        node& got = slot();
+        if (in_place(val))
+            got.data = node::view_t(val);
+        else
+            got.assign(node::str_t(val, resource));
+        return true;
+    }
+
+    // the member is made here, so the key need not outlive the call
+    bool key(std::string_view val)
+    {
+        auto& obj = *stack.back().obj;
+        auto [it, fresh] = keys ? obj.try_emplace(keys->intern(val)) : obj.try_emplace(val);
+        member = fresh ? &it->second : &discard.emplace_back();
+        return true;
+    }
+
+    bool start_object()
+    {
+        node& got = slot();
+        got.assign(node::obj_t(resource));
+        stack.push_back({ nullptr, &got.get<node::obj_t>() });
+        return true;
+    }
+
+    bool start_array()
+    {
+        node& got = slot();
+        got.assign(node::arr_t(resource));
+        stack.push_back({ &got.get<node::arr_t>(), nullptr });
+        return true;
+    }
+
+    // the container just started has count elements or members
+    void reserve(std::size_t count)
+    {
+        auto& top = stack.back();
+        top.arr ? top.arr->reserve(count) : top.obj->reserve(count);
+    }
+
+    bool end_object(std::size_t)
+    {
+        stack.pop_back();
+        return true;
+    }
+
+    bool end_array(std::size_t)
+    {
+        stack.pop_back();
+        return true;
+    }
+};
+
+}; // namespace mini_json::detail
@@ -0,0 +1,392 @@
+#pragma once
+#include "binary.hpp"
+#include "json.hpp"
+#include "node.hpp"
+#include "sink.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace mini_json {
+
+/**
+ * cbor encodes a node to cbor (rfc 8949) and decodes it back,
+ * or into the events of json::parse(handler), like msgpack does
+ * integers take their smallest head, doubles are always float64
+ * on decoding, half and single floats are widened, byte strings
+ * become strings, undefined is null, tags are skipped over
+ * and strings, arrays and maps may have an indefinite length
+ * a negative integer below int64 becomes a double
+ * strings passed to a handler refer to the input, except those
+ * made of chunks, which are only valid during the call
+ */
+class cbor {
+
+public:
+    using error_code = json::error_code;
+
+private:
+    // the major type of an item
+    enum kind : unsigned char {
+        unsigned_int,
+        negative_int,
+        byte_string,
+        text_string,
+        array,
+        map,
+        tag,
+        simple,
+    };
+
+    // the additional information of an indefinite length
+    constexpr static unsigned char indefinite = 31;
+    constexpr static char brk = '\xFF';
+
+    char const* it = nullptr;
+    char const* end = nullptr;
+    // the chunks of an indefinite string, joined
+    std::string joined;
+    error_code err = error_code::non;
+
+    bool fail(error_code code) noexcept
+    {
+        err = code;
+        return false;
+    }
+
+    bool check(bool go) noexcept
+    {
+        return go || fail(error_code::aborted);
+    }
+
+    template <typename Out>
+    static void put_head(Out& out, kind type, std::uint64_t val)
+    {
+        auto lead = static_cast<char>(type << 5);
+        char* first = out.reserve(9);
+
+        if (val < 24) {
+            *first = char(lead | val);
+            out.commit(first + 1);
+        } else if (val <= 0xFF) {
+            *first = char(lead | 24);
+            out.commit(detail::store_be(first + 1, std::uint8_t(val)));
+        } else if (val <= 0xFFFF) {
+            *first = char(lead | 25);
+            out.commit(detail::store_be(first + 1, std::uint16_t(val)));
+        } else if (val <= 0xFFFFFFFF) {
+            *first = char(lead | 26);
+            out.commit(detail::store_be(first + 1, std::uint32_t(val)));
+        } else {
+            *first = char(lead | 27);
+            out.commit(detail::store_be(first + 1, val));
+        }
+    }
+
+    template <typename Out>
+    static void put_string(Out& out, std::string_view str)
+    {
+        put_head(out, text_string, str.size());
+        out.append(str);
+    }
+
+    template <typename Out>
+    static void encode_value(Out& out, node const& mnode)
+    {
+        switch (mnode.type()) {
+        case node::data_k::null:
+            out.put('\xF6');
+            break;
+
+        case node::data_k::boolean:
+            out.put(mnode.get<bool>() ? '\xF5' : '\xF4');
+            break;
+
+        case node::data_k::number: {
+            char* first = out.reserve(9);
+            *first = '\xFB';
+            out.commit(detail::store_double(first + 1, mnode.get<node::num_t>()));
+            break;
+        }
+
+        case node::data_k::integer: {
+            auto val = mnode.get<node::int_t>();
+            if (val >= 0)
+                put_head(out, unsigned_int, std::uint64_t(val));
+            else
+                put_head(out, negative_int, ~std::uint64_t(val));
+            break;
+        }
+
+        case node::data_k::uinteger:
+            put_head(out, unsigned_int, mnode.get<node::uint_t>());
+            break;
+
+        case node::data_k::string:
+            put_string(out, mnode.get<node::str_t>());
+            break;
+
+        case node::data_k::view:
+            put_string(out, mnode.get<node::view_t>());
+            break;
+
+        case node::data_k::array: {
+            auto& arr = mnode.get<node::arr_t>();
+            put_head(out, array, arr.size());
+            for (auto& elem : arr)
+                encode_value(out, elem);
+            break;
+        }
+
+        case node::data_k::object: {
+            auto& obj = mnode.get<node::obj_t>();
+            put_head(out, map, obj.size());
+            for (auto& ent : obj) {
+                put_string(out, ent.first);
+                encode_value(out, ent.second);
+            }
+            break;
+        }
+        }
+    }
+
+    // read the next size bytes, or fail on truncated input
+    bool take(std::size_t size, char const*& got) noexcept
+    {
+        if (std::size_t(end - it) < size)
+            return fail(error_code::invalid_value);
+        got = it;
+        it += size;
+        return true;
+    }
+
+    /**
+     * read the head of the next item, info is its additional information
+     * and val its argument, which is left alone for an indefinite length
+     */
+    bool take_head(kind& type, unsigned char& info, std::uint64_t& val) noexcept
+    {
+        if (it == end)
+            return fail(error_code::expect_value);
+
+        auto lead = static_cast<unsigned char>(*it++);
+        type = kind(lead >> 5);
+        info = lead & 0x1F;
+
+        if (info >= 28 && info < indefinite)
+            return fail(error_code::invalid_value);
+
+        val = info;
+        if (info < 24 || info == indefinite)
+            return true;
+
+        // 24 to 27 are followed by 1, 2, 4 or 8 bytes
+        char const* got;
+        std::size_t size = std::size_t(1) << (info - 24);
+        if (!take(size, got))
+            return false;
+
+        val = 0;
+        for (std::size_t i = 0; i < size; ++i)
+            val = val << 8 | static_cast<unsigned char>(got[i]);
+        return true;
+    }
+
+    // whether the next byte ends an indefinite item, which is then skipped
+    bool at_break() noexcept
+    {
+        if (it == end || *it != brk)
+            return false;
+        ++it;
+        return true;
+    }
+
+    template <typename Handler>
+    bool decode_string(Handler& handler, kind type, unsigned char info, std::uint64_t len, bool key)
+    {
+        char const* got;
+        std::string_view str;
+
+        if (info != indefinite) {
+            if (!take(len, got))
+                return false;
+            str = std::string_view(got, len);
+        } else {
+            // every chunk is a definite string of the same type
+            joined.clear();
+            while (!at_break()) {
+                kind chunk;
+                if (!take_head(chunk, info, len))
+                    return false;
+                if (chunk != type || info == indefinite || !take(len, got))
+                    return fail(error_code::invalid_value);
+                joined.append(got, len);
+            }
+            str = joined;
+        }
+
+        return check(key ? handler.key(str) : handler.string(str));
+    }
+
+    template <typename Handler>
+    bool decode_array(Handler& handler, unsigned char info, std::uint64_t len)
+    {
+        if (!check(handler.start_array()))
+            return false;
+        if (info != indefinite)
+            detail::reserve(handler, std::min<std::uint64_t>(len, end - it));
+
+        std::size_t count = 0;
+        for (; info == indefinite ? !at_break() : count < len; ++count)
+            if (!decode_value(handler))
+                return false;
+
+        return check(handler.end_array(count));
+    }
+
+    template <typename Handler>
+    bool decode_map(Handler& handler, unsigned char info, std::uint64_t len)
+    {
+        if (!check(handler.start_object()))
+            return false;
+        if (info != indefinite)
+            detail::reserve(handler, std::min<std::uint64_t>(len, (end - it) / 2));
+
+        std::size_t count = 0;
+        for (; info == indefinite ? !at_break() : count < len; ++count) {
+            kind type;
+            unsigned char kinfo;
+            std::uint64_t klen;
+
+            if (!take_head(type, kinfo, klen))
+                return false;
+            if (type != text_string)
+                return fail(error_code::invalid_key);
+
+            if (!decode_string(handler, type, kinfo, klen, true) || !decode_value(handler))
+                return false;
+        }
+
+        return check(handler.end_object(count));
+    }
+
+    template <typename Handler>
+    bool decode_value(Handler& handler)
+    {
+        kind type;
+        unsigned char info;
+        std::uint64_t val;
+
+        // tags only tell how to read a value, which json cannot hold
+        do {
+            if (!take_head(type, info, val))
+                return false;
+            if (info == indefinite && (type == unsigned_int || type == negative_int || type == tag))
+                return fail(error_code::invalid_value);
+        } while (type == tag);
+
+        switch (type) {
+        case unsigned_int:
+            // like the text parser, an integer that fits stays signed
+            if (val <= std::uint64_t(std::numeric_limits<node::int_t>::max()))
+                return check(handler.integer(node::int_t(val)));
+            return check(handler.uinteger(val));
+
+        case negative_int:
+            if (val <= std::uint64_t(std::numeric_limits<node::int_t>::max()))
+                return check(handler.integer(-1 - node::int_t(val)));
+            return check(handler.number(-1.0 - double(val)));
+
+        case byte_string:
+        case text_string:
+            return decode_string(handler, type, info, val, false);
+
+        case array:
+            return decode_array(handler, info, val);
+
+        case map:
+            return decode_map(handler, info, val);
+
+        default:
+            break;
+        }
+
+        // simple values and floats, the argument holds the bits of a float
+        char bits[8];
+        switch (info) {
+        case 20:
+        case 21:
+            return check(handler.boolean(info == 21));
+        case 22:
+        case 23:
+            return check(handler.null());
+        case 25:
+            detail::store_be(bits, std::uint16_t(val));
+            return check(handler.number(detail::load_half(bits)));
+        case 26:
+            detail::store_be(bits, std::uint32_t(val));
+            return check(handler.number(detail::load_float(bits)));
+        case 27:
+            detail::store_be(bits, val);
+            return check(handler.number(detail::load_double(bits)));
+        default:
+            // a break outside of an indefinite item, or another simple value
+            return fail(error_code::invalid_value);
+        }
+    }
+
+public:
+    /**
+     * write root to sink through a small fixed buffer
+     */
+    template <typename Sink>
+    bool encode(node const& root, Sink& sink)
+    {
+        err = error_code::non;
+        detail::writer<Sink> out(sink);
+        encode_value(out, root);
+        return out.flush() || fail(error_code::write_failed);
+    }
+
+    std::string encode(node const& root)
+    {
+        std::string ret;
+        string_sink sink(ret);
+        encode(root, sink);
+        return ret;
+    }
+
+    /**
+     * decode one item that spans the whole input into events,
+     * like json::parse(handler)
+     */
+    template <typename Handler>
+    bool decode(std::string_view input, Handler& handler)
+    {
+        it = input.data();
+        end = it + input.size();
+        err = error_code::non;
+
+        if (!decode_value(handler))
+            return false;
+
+        return it == end || fail(error_code::root_singular);
+    }
+
+    // out is left unspecified when decoding fails
+    bool decode(std::string_view input, node& out)
+    {
+        detail::node_builder builder(out);
+        return decode(input, builder);
+    }
+
+    error_code errp() const noexcept
+    {
+        return err;
+    }
+};
+
+}; // namespace mini_json
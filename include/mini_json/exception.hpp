@@ -27,4 +27,28 @@ public:
     }
 };
 
+class bad_parse : public std::exception {
+public:
+    char const* what() const noexcept override
+    {
+        return "the document is not valid json where it was read";
+    }
+};
+
+class bad_pointer : public std::exception {
+public:
+    char const* what() const noexcept override
+    {
+        return "the given string is not a valid json pointer";
+    }
+};
+
+class bad_snapshot : public std::exception {
+public:
+    char const* what() const noexcept override
+    {
+        return "the data is not a valid snapshot where it was read";
+    }
+};
+
 };
\ No newline at end of file
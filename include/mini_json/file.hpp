@@ -0,0 +1,176 @@
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MINI_JSON_MMAP
+#else
+#include <fstream>
+#include <vector>
+#endif
+
+namespace mini_json {
+
+/**
+ * mapped_file maps a whole file read-only, so json can parse it in place
+ * the mapping is followed by zeroed padding, so data()[size()] is '\0'
+ * just like the terminator of a std::string, and the kernel is told
+ * that the file will be read once from start to end, with its first
+ * prefetch_size bytes read in at once, or for random access, that only
+ * the pages touched should be read in
+ * where mmap is not available the file is read into a buffer instead
+ * failing to open or map the file throws std::system_error
+ */
+class mapped_file {
+
+private:
+#if defined(MINI_JSON_MMAP)
+    char* base = nullptr;
+    // mapped bytes, including the padding
+    std::size_t length = 0;
+#else
+    std::vector<char> buffer;
+#endif
+    std::size_t bytes = 0;
+
+    [[noreturn]] static void fail(int err, std::string const& path)
+    {
+        throw std::system_error(err, std::generic_category(), "mini_json::mapped_file : " + path);
+    }
+
+public:
+    // bytes read ahead when mapped for sequential access, the kernel keeps
+    // reading ahead of the parser from there without the whole file in memory
+    constexpr static std::size_t prefetch_size = std::size_t(4) << 20;
+
+    enum class access {
+        sequential,
+        random,
+    };
+
+    mapped_file() = default;
+
+#if defined(MINI_JSON_MMAP)
+    explicit mapped_file(std::string const& path, access hint = access::sequential)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            fail(errno, path);
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            fail(err, path);
+        }
+
+        // at least one byte of padding, rounded up to whole pages
+        auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        bytes = static_cast<std::size_t>(st.st_size);
+        length = (bytes / page + 1) * page;
+
+        // reserve zeroed pages first, then map the file over the front of them
+        void* got = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (got == MAP_FAILED || (bytes && ::mmap(got, bytes, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)) {
+            int err = errno;
+            if (got != MAP_FAILED)
+                ::munmap(got, length);
+            ::close(fd);
+            fail(err, path);
+        }
+
+        // the mapping keeps the file open
+        ::close(fd);
+        base = static_cast<char*>(got);
+
+#if defined(MADV_SEQUENTIAL) && defined(MADV_WILLNEED) && defined(MADV_RANDOM)
+        if (hint == access::sequential) {
+            ::madvise(base, length, MADV_SEQUENTIAL);
+            ::madvise(base, length < prefetch_size ? length : prefetch_size, MADV_WILLNEED);
+        } else {
+            ::madvise(base, length, MADV_RANDOM);
+        }
+#else
+        (void)hint;
+#endif
+    }
+
+    mapped_file(mapped_file&& src) noexcept
+        : base(std::exchange(src.base, nullptr))
+        , length(std::exchange(src.length, 0))
+        , bytes(std::exchange(src.bytes, 0))
+    {
+    }
+
+    mapped_file& operator=(mapped_file&& src) noexcept
+    {
+        if (this != &src) {
+            if (base)
+                ::munmap(base, length);
+            base = std::exchange(src.base, nullptr);
+            length = std::exchange(src.length, 0);
+            bytes = std::exchange(src.bytes, 0);
+        }
+        return *this;
+    }
+
+    ~mapped_file()
+    {
+        if (base)
+            ::munmap(base, length);
+    }
+
+    char const* data() const noexcept
+    {
+        return base;
+    }
+#else
+    explicit mapped_file(std::string const& path, access = access::sequential)
+    {
+        std::ifstream fs(path, std::ios::binary | std::ios::ate);
+        if (!fs)
+            fail(ENOENT, path);
+
+        bytes = static_cast<std::size_t>(fs.tellg());
+        buffer.assign(bytes + 1, '\0');
+        fs.seekg(0);
+        if (!fs.read(buffer.data(), static_cast<std::streamsize>(bytes)))
+            fail(EIO, path);
+    }
+
+    mapped_file(mapped_file&& src) noexcept
+        : buffer(std::move(src.buffer))
+        , bytes(std::exchange(src.bytes, 0))
+    {
+    }
+
+    mapped_file& operator=(mapped_file&& src) noexcept
+    {
+        buffer = std::move(src.buffer);
+        bytes = std::exchange(src.bytes, 0);
+        return *this;
+    }
+
+    char const* data() const noexcept
+    {
+        return buffer.empty() ? nullptr : buffer.data();
+    }
+#endif
+
+    mapped_file(mapped_file const&) = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+
+    std::size_t size() const noexcept
+    {
+        return bytes;
+    }
+};
+
+}; // namespace mini_json
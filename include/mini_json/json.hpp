@@ -1,10 +1,41 @@
 #pragma once
+#include "builder.hpp"
+#include "file.hpp"
 #include "node.hpp"
+#include "number.hpp"
+#include "scan.hpp"
+#include "sink.hpp"
+#include "string.hpp"
+#include "tape.hpp"
+#include <algorithm>
 #include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 
 namespace mini_json {
 
+/**
+ * options tune how json parses its context
+ */
+struct options {
+    // allocate the whole node tree from a monotonic arena owned by json
+    // the tree is then released at once when json is reparsed or destroyed
+    // and nodes moved out of it must not outlive the json object
+    bool arena = false;
+
+    // keep strings without escapes as views into the context
+    // such nodes are only valid as long as the json object
+    // a string is then held as view_t or str_t depending on its escapes
+    // and get<std::string_view>() reads it either way
+    bool insitu = false;
+
+    // store every distinct object key once in a pool owned by json
+    // objects then hold handles to it, which makes repeated keys cheap
+    // such nodes are only valid as long as the json object
+    bool intern = false;
+};
+
 /**
  * json provides the parsing and stringing manipulation
  */
@@ -22,27 +53,126 @@ public:
         invalid_value,
         miss_separator,
         invalid_escape,
+        aborted,
+        write_failed,
     };
 
 private:
+    // arena is declared first, so it outlives the tree allocated from it
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::memory_resource* resource;
+    key_pool keys;
+    options opt;
     std::unique_ptr<node> root = nullptr;
     std::unique_ptr<std::string> string = nullptr;
+    // escaped strings are decoded here before they are passed on
+    std::string decoded;
     std::string context;
-    std::string::iterator context_it;
+    mapped_file file;
+    // the document, held by either context or file
+    char const* context_begin;
+    char const* context_it;
+    char const* context_end;
     error_code perr = error_code::non;
     error_code serr = error_code::non;
 
+    // keeps the constructor of from_view apart from json(text, opt)
+    struct view_tag {
+    };
+
+    json(view_tag, std::string_view input, options opt)
+        : arena(std::max<std::size_t>(input.size(), 1024))
+        , resource(opt.arena ? &arena : std::pmr::get_default_resource())
+        , opt(opt)
+        , context_begin(input.data())
+        , context_it(context_begin)
+        , context_end(context_begin + input.size())
+    {
+    }
+
 public:
     /**
      * json accept an context while construcing
      * which could copy or move from argument
      */
-    json(std::string init)
-        : context(std::move(init))
-        , context_it(context.begin())
+    json(std::string init, options opt = {})
+        : arena(std::max<std::size_t>(init.size(), 1024))
+        , resource(opt.arena ? &arena : std::pmr::get_default_resource())
+        , opt(opt)
+        , context(std::move(init))
+        , context_begin(context.data())
+        , context_it(context_begin)
+        , context_end(context_begin + context.size())
     {
     }
 
+    /**
+     * json parses a mapped file in place, without copying it
+     */
+    json(mapped_file init, options opt = {})
+        : arena(std::max<std::size_t>(init.size(), 1024))
+        , resource(opt.arena ? &arena : std::pmr::get_default_resource())
+        , opt(opt)
+        , file(std::move(init))
+        , context_begin(file.data() ? file.data() : context.data())
+        , context_it(context_begin)
+        , context_end(context_begin + file.size())
+    {
+    }
+
+    /**
+     * json refers to input without copying it
+     * input must outlive the json object and is never read past its end
+     */
+    static json from_view(std::string_view input, options opt = {})
+    {
+        return json(view_tag {}, input, opt);
+    }
+
+    /**
+     * map the file at path and parse it in place
+     * throws std::system_error if it cannot be opened or mapped
+     */
+    static json from_file(std::string const& path, options opt = {})
+    {
+        return json(mapped_file(path), opt);
+    }
+
+    /**
+     * replace the context, so one json can parse many documents
+     * while keeping the capacity of its buffers and arena
+     * the previous tree and everything it referred to is released
+     */
+    void reset(std::string_view init)
+    {
+        root = nullptr;
+        arena.release();
+        keys.clear();
+
+        file = mapped_file();
+        context.assign(init.data(), init.size());
+        context_begin = context.data();
+        context_it = context_begin;
+        context_end = context_begin + context.size();
+        perr = error_code::non;
+        serr = error_code::non;
+    }
+
+    // like reset, but refer to input instead of copying it
+    void reset_view(std::string_view input)
+    {
+        root = nullptr;
+        arena.release();
+        keys.clear();
+
+        file = mapped_file();
+        context_begin = input.data();
+        context_it = context_begin;
+        context_end = context_begin + input.size();
+        perr = error_code::non;
+        serr = error_code::non;
+    }
+
     /**
      * parse operation will try to parse the context to root node
      * which should return an optional
@@ -50,16 +180,74 @@ public:
      */
     node* parse()
     {
-        if (!root)
-            root = std::make_unique<node>();
+        // the previous tree goes first, then the arena and keys it used
+        root = nullptr;
+        arena.release();
+        keys.clear();
+        root = std::make_unique<node>();
 
-        if (root && parse_value(*root))
+        detail::node_builder builder(*root, resource, opt.intern ? &keys : nullptr,
+            opt.insitu ? std::string_view(context_begin, context_end - context_begin) : std::string_view());
+        if (parse(builder))
             return root.get();
 
         root = nullptr;
         return nullptr;
     }
 
+    /**
+     * parse the context to a flat tape instead of a node tree
+     * the tape is cleared first, so its capacity can be reused
+     */
+    bool parse(tape& doc)
+    {
+        doc.clear();
+        std::size_t size = context_end - context_begin;
+        doc.entries.reserve(size / 4 + 16);
+        doc.strings.reserve(size / 2 + 16);
+
+        tape::builder builder(doc);
+        if (parse(builder))
+            return true;
+
+        doc.clear();
+        return false;
+    }
+
+    /**
+     * parse the context as a stream of events sent to handler
+     * no node is built, handler provides the methods below
+     * and any of them may return false to stop parsing at once
+     *     bool null()
+     *     bool boolean(bool val)
+     *     bool integer(node::int_t val)
+     *     bool uinteger(node::uint_t val)
+     *     bool number(node::num_t val)
+     *     bool string(std::string_view val)
+     *     bool key(std::string_view val)
+     *     bool start_object()
+     *     bool end_object(std::size_t count)
+     *     bool start_array()
+     *     bool end_array(std::size_t count)
+     * strings are only valid during the call
+     */
+    template <typename Handler>
+    bool parse(Handler& handler)
+    {
+        context_it = context_begin;
+        perr = error_code::non;
+
+        if (!sax_value(handler))
+            return false;
+
+        parse_ws();
+        if (context_it == context_end)
+            return true;
+
+        perr = error_code::root_singular;
+        return false;
+    }
+
     /**
      * str operation will try to stringify the root node to string
      * which should also return an optional
@@ -70,13 +258,47 @@ public:
         if (!string)
             string = std::make_unique<std::string>();
 
-        if (root && str_value(*root))
+        // every str starts over with an empty output, keeping its capacity
+        string->clear();
+
+        string_sink sink(*string);
+        if (write(sink))
             return string.get();
 
         string = nullptr;
         return nullptr;
     }
 
+    /**
+     * str_size is the exact size of the output of str and write
+     * found by walking the tree without writing it, so the output
+     * can go to a buffer_sink allocated once, it is zero without a root
+     */
+    std::size_t str_size()
+    {
+        return root ? size_value(*root) : 0;
+    }
+
+    /**
+     * write stringifies the root node like str, but passes the output
+     * to sink through a small fixed buffer instead of one string,
+     * so documents of any size are written in constant memory
+     * a failing sink stops the output with error_code::write_failed
+     */
+    template <typename Sink>
+    bool write(Sink& sink)
+    {
+        serr = error_code::non;
+        if (!root)
+            return false;
+
+        detail::writer<Sink> out(sink);
+        bool done = str_value(out, *root);
+        if (!out.flush())
+            serr = error_code::write_failed;
+        return done && out.good();
+    }
+
     /**
      * get error code
      */
@@ -92,406 +314,393 @@ public:
 
 private:
     /**
-     * submethods about parsing
+     * submethods about parsing, the grammar is only in the sax ones
+     * and trees and tapes are built by handlers of their events
      */
-    bool parse_unicode(std::string& out);
-    bool parse_key(std::string& str);
-    bool parse_literal(node& mnode);
-    bool parse_object(node& mnode);
-    bool parse_string(node& mnode);
-    bool parse_number(node& mnode);
-    bool parse_value(node& mnode);
-    bool parse_array(node& mnode);
+    bool lex_string(std::string& str);
+    char lex_literal();
     void parse_ws();
 
-    // submethods about stringing
-    std::string str_string(std::string_view src);
-    bool str_literal(node& mnode);
-    bool str_object(node& mnode);
-    bool str_value(node& mnode);
-    bool str_array(node& mnode);
-};
-
-/**
- * parse_value take charge of distinguish the type of subnode
- * and dispatching the parsing tasks to other submethods
- */
-inline bool json::parse_value(node& mnode)
-{
-    parse_ws();
-    switch (*context_it) {
-    case 'n':
-        return parse_literal(mnode);
-
-    case 't':
-        return parse_literal(mnode);
-
-    case 'f':
-        return parse_literal(mnode);
-
-    case '\"':
-        return parse_string(mnode);
-
-    case '[':
-        return parse_array(mnode);
-
-    case '{':
-        return parse_object(mnode);
-
-    default:
-        return parse_number(mnode);
-
-    case '\0':
-        perr = error_code::expect_value;
-        return false;
+    // the next byte, or '\0' at the end of the context
+    char peek() const noexcept
+    {
+        return context_it != context_end ? *context_it : '\0';
     }
-}
+
+    template <typename Handler>
+    bool sax_object(Handler& handler);
+    template <typename Handler>
+    bool sax_string(Handler& handler, bool key);
+    template <typename Handler>
+    bool sax_number(Handler& handler);
+    template <typename Handler>
+    bool sax_value(Handler& handler);
+    template <typename Handler>
+    bool sax_array(Handler& handler);
+
+    // submethods about measuring the output of stringing
+    std::size_t size_string(std::string_view src);
+    std::size_t size_value(node& mnode);
+
+    // submethods about stringing, out is a detail::writer
+    template <typename Out, typename T>
+    void str_number(Out& out, T val);
+    template <typename Out>
+    void str_string(Out& out, std::string_view src);
+    template <typename Out>
+    bool str_literal(Out& out, node& mnode);
+    template <typename Out>
+    bool str_object(Out& out, node& mnode);
+    template <typename Out>
+    bool str_value(Out& out, node& mnode);
+    template <typename Out>
+    bool str_array(Out& out, node& mnode);
+};
 
 /**
  * parse_ws let iterator point to next non-empty charactor
  */
 inline void json::parse_ws()
 {
-    auto& it = context_it;
-    while (*it == ' ' || *it == '\n' || *it == '\t' || *it == '\r')
-        ++it;
+    context_it = detail::skip_ws(context_it, context_end);
 }
 
 /**
- * parse_literal take charge of parsing literal value
- * which includes null and bool
+ * lex_literal matches null, true or false at the iterator
+ * and returns its first charactor, or 0 if none of them is there
  */
-inline bool json::parse_literal(node& mnode)
+inline char json::lex_literal()
 {
     auto& it = context_it;
+    std::size_t left = context_end - it;
 
     // value is null
-    if (*(it + 1) == 'u' && *(it + 2) == 'l' && *(it + 3) == 'l') {
+    if (left >= 4 && it[0] == 'n' && it[1] == 'u' && it[2] == 'l' && it[3] == 'l') {
         it += 4;
-        mnode.assign(nullptr);
-        return true;
+        return 'n';
     }
 
     // value is true
-    if (*(it + 1) == 'r' && *(it + 2) == 'u' && *(it + 3) == 'e') {
+    if (left >= 4 && it[0] == 't' && it[1] == 'r' && it[2] == 'u' && it[3] == 'e') {
         it += 4;
-        mnode.assign(true);
-        return true;
+        return 't';
     }
 
     // value is false
-    if (*(it + 1) == 'a' && *(it + 2) == 'l' && *(it + 3) == 's' && *(it + 4) == 'e') {
+    if (left >= 5 && it[0] == 'f' && it[1] == 'a' && it[2] == 'l' && it[3] == 's' && it[4] == 'e') {
         it += 5;
-        mnode.assign(false);
-        return true;
+        return 'f';
     }
 
-    // invalid value
-    perr = error_code::invalid_value;
-    return false;
+    return 0;
 }
 
 /**
- * parse_number take care of parsing the number literal
- * which is supported by standard function :)
+ * lex_string decodes a string with escapes, it is a submethod of sax_string
+ * the decoding itself is shared with push_parser
  */
-inline bool json::parse_number(node& mnode)
+inline bool json::lex_string(std::string& str)
 {
-    auto& it = context_it;
-    char *st = &*it, *ed = st;
+    switch (detail::unescape(++context_it, context_end, str)) {
+    case detail::string_error::non:
+        return true;
 
-    double num = static_cast<double>(std::strtod(st, &ed));
-    if (st == ed) {
+    case detail::string_error::unterminated:
         perr = error_code::invalid_value;
         return false;
-    }
 
-    it += ed - st;
-    mnode.assign(num);
-    return true;
+    default:
+        perr = error_code::invalid_escape;
+        return false;
+    }
 }
 
 /**
- * parse_unicode is a submethod of parse_string and parse_key
- * which only support to convert the unicode to UTF-8
+ * sax_value take charge of distinguishing the type of a value
+ * and dispatching its events to handler through the other submethods
+ * it is the only grammar, node trees and tapes are its handlers too
+ * every event goes through check, which turns a false from
+ * the handler into error_code::aborted
  */
-inline bool json::parse_unicode(std::string& out)
+template <typename Handler>
+inline bool json::sax_value(Handler& handler)
 {
-    auto& it = ++context_it;
-    // check whether the first character is space, space is invalid
-    if (std::isspace(*it)) {
-        perr = error_code::invalid_escape;
+    auto check = [this](bool go) {
+        if (!go)
+            perr = error_code::aborted;
+        return go;
+    };
+
+    parse_ws();
+    switch (peek()) {
+    case 'n':
+    case 't':
+    case 'f':
+        switch (lex_literal()) {
+        case 'n':
+            return check(handler.null());
+        case 't':
+            return check(handler.boolean(true));
+        case 'f':
+            return check(handler.boolean(false));
+        }
+        perr = error_code::invalid_value;
+        return false;
+
+    case '\"':
+        return sax_string(handler, false);
+
+    case '[':
+        return sax_array(handler);
+
+    case '{':
+        return sax_object(handler);
+
+    default:
+        return sax_number(handler);
+
+    case '\0':
+        perr = error_code::expect_value;
         return false;
     }
+}
 
-    uint32_t code = 0;
-    char* end = nullptr;
-    code = (uint32_t)std::strtol(&*it, &end, 16);
-    // check if convertion is success
-    if (end != &*it + 4) {
-        perr = error_code::invalid_escape;
+/**
+ * strings without escapes are passed as views into the context
+ * the others are decoded into a buffer reused from one to the next
+ */
+template <typename Handler>
+inline bool json::sax_string(Handler& handler, bool key)
+{
+    auto emit = [&](std::string_view str) {
+        bool go = key ? handler.key(str) : handler.string(str);
+        if (!go)
+            perr = error_code::aborted;
+        return go;
+    };
+
+    char const* st = context_it + 1;
+    char const* run = detail::next_quote(st, context_end);
+
+    if (run != context_end && *run == '\"') {
+        context_it = run + 1;
+        return emit(std::string_view(st, run - st));
+    }
+
+    if (!lex_string(decoded))
+        return false;
+
+    return emit(decoded);
+}
+
+template <typename Handler>
+inline bool json::sax_number(Handler& handler)
+{
+    detail::number_literal num;
+
+    if (!detail::scan_number(context_it, context_end, num)) {
+        perr = error_code::invalid_value;
         return false;
     }
 
-    char tmp[4] = { 0 };
-    std::size_t len = 0;
-    if (code <= 0x7F) {
-        tmp[0] = char(code & 0xFF);
-        len = 1;
-    } else if (code <= 0x7FF) {
-        tmp[0] = char(0xC0 | ((code >> 6) & 0xFF));
-        tmp[1] = char(0x80 | (code & 0x3F));
-        len = 2;
-    } else if (code <= 0xFFFF) {
-        tmp[0] = char(0xE0 | ((code >> 12) & 0xFF));
-        tmp[1] = char(0x80 | ((code >> 6) & 0x3F));
-        tmp[2] = char(0x80 | (code & 0x3F));
-        len = 3;
-    } else if (code <= 0x10FFFF) {
-        tmp[0] = char(0xF0 | ((code >> 18) & 0xFF));
-        tmp[1] = char(0x80 | ((code >> 12) & 0x3F));
-        tmp[2] = char(0x80 | ((code >> 6) & 0x3F));
-        tmp[3] = char(0x80 | (code & 0x3F));
-        len = 4;
-    } else {
-        perr = error_code::invalid_escape;
+    bool go = true;
+    if (!detail::emit_number(num, handler, go)) {
+        perr = error_code::invalid_value;
         return false;
     }
 
-    out.append(tmp, len);
-    it += 3;
-    return true;
+    context_it = num.end;
+    if (!go)
+        perr = error_code::aborted;
+    return go;
 }
 
-/**
- * parse_string support parsing escape charactor and unicode
- * but it only support to parse to UTF-8 charactors
- */
-inline bool json::parse_string(node& mnode)
+template <typename Handler>
+inline bool json::sax_array(Handler& handler)
 {
-    auto& it = context_it;
-    std::string rlt;
+    auto& it = ++context_it;
+    std::size_t count = 0;
 
-    while (true) {
-        switch (*++it) {
-        case '\"': {
-            mnode.assign(std::move(rlt));
-            ++it;
-            return true;
-        }
+    if (!handler.start_array()) {
+        perr = error_code::aborted;
+        return false;
+    }
 
-        case '\0':
-            perr = error_code::invalid_value;
-            return false;
+    parse_ws();
+    if (peek() != ']') {
+        while (true) {
+            if (!sax_value(handler))
+                return false;
+            ++count;
 
-        case '\\':
-            switch (*++it) {
-            case '\"':
-                rlt.append("\"");
-                break;
-            case '\\':
-                rlt.append("\\");
-                break;
-            case '/':
-                rlt.append("/");
-                break;
-            case 'b':
-                rlt.append("\b");
-                break;
-            case 'f':
-                rlt.append("\f");
-                break;
-            case 'n':
-                rlt.append("\n");
-                break;
-            case 'r':
-                rlt.append("\r");
-                break;
-            case 't':
-                rlt.append("\t");
+            parse_ws();
+            if (peek() == ']')
                 break;
-            case 'u': {
-                std::string ustr;
-                if (!parse_unicode(ustr))
-                    return false;
-                rlt.append(ustr);
-                break;
-            }
-            default:
-                perr = error_code::invalid_escape;
+
+            if (peek() != ',') {
+                perr = error_code::miss_separator;
                 return false;
             }
-            break;
-
-        default:
-            rlt.append(&*it, 1);
-            break;
+            ++it;
         }
     }
+
+    ++it;
+    if (!handler.end_array(count)) {
+        perr = error_code::aborted;
+        return false;
+    }
+    return true;
 }
 
-/**
- * parse_array take charge of parsing array datastruture
- * which use vector as default container
- */
-inline bool json::parse_array(node& mnode)
+template <typename Handler>
+inline bool json::sax_object(Handler& handler)
 {
     auto& it = ++context_it;
-    parse_ws();
-    mnode.assign(node::arr_t());
+    std::size_t count = 0;
 
-    if (*it == ']') {
-        ++it;
-        return true;
+    if (!handler.start_object()) {
+        perr = error_code::aborted;
+        return false;
     }
 
-    node cnode;
-    auto& arr = mnode.get<node::arr_t>();
+    parse_ws();
+    if (peek() != '}') {
+        while (true) {
+            parse_ws();
+            if (peek() != '\"') {
+                perr = error_code::invalid_key;
+                return false;
+            }
 
-    while (true) {
-        if (!parse_value(cnode))
-            return false;
+            if (!sax_string(handler, true))
+                return false;
 
-        arr.push_back(std::move(cnode));
+            parse_ws();
+            if (peek() != ':') {
+                perr = error_code::miss_separator;
+                return false;
+            }
+            ++it;
 
-        parse_ws();
-        if (*it == ']') {
+            if (!sax_value(handler))
+                return false;
+            ++count;
+
+            parse_ws();
+            if (peek() == '}')
+                break;
+
+            if (peek() != ',') {
+                perr = error_code::miss_separator;
+                return false;
+            }
             ++it;
-            return true;
         }
+    }
 
-        if (*it == ',')
-            ++it;
+    ++it;
+    if (!handler.end_object(count)) {
+        perr = error_code::aborted;
+        return false;
     }
+    return true;
 }
 
 /**
- * parse_key is a submethod of parse_object
- * object use a string as its key
+ * size_string counts a string as str_string writes it
+ * an escaped byte takes two bytes, or six for the other control bytes
  */
-inline bool json::parse_key(std::string& key)
+inline std::size_t json::size_string(std::string_view src)
 {
-    auto& it = context_it;
-
-    while (true) {
-        switch (*++it) {
-        case '\"': {
-            ++it;
-            return true;
-        }
-
-        case '\0':
-            perr = error_code::invalid_value;
-            return false;
+    char const* it = src.data();
+    char const* end = it + src.size();
+    std::size_t len = src.size() + 2;
 
+    while ((it = detail::next_escape(it, end)) != end) {
+        switch (*it++) {
+        case '\"':
         case '\\':
-            switch (*++it) {
-            case '\"':
-                key.append("\"");
-                break;
-            case '\\':
-                key.append("\\");
-                break;
-            case '/':
-                key.append("/");
-                break;
-            case 'b':
-                key.append("\b");
-                break;
-            case 'f':
-                key.append("\f");
-                break;
-            case 'n':
-                key.append("\n");
-                break;
-            case 'r':
-                key.append("\r");
-                break;
-            case 't':
-                key.append("\t");
-                break;
-            case 'u': {
-                std::string ustr;
-                if (!parse_unicode(ustr))
-                    return false;
-                key.append(ustr);
-                break;
-            }
-            default:
-                perr = error_code::invalid_escape;
-                return false;
-            }
+        case '\b':
+        case '\f':
+        case '\n':
+        case '\r':
+        case '\t':
+            len += 1;
             break;
-
         default:
-            key.append(&*it, 1);
+            len += 5;
             break;
         }
     }
+
+    return len;
 }
 
 /**
- * parse_object take charge of parsing object datastructure
- * object node use unordered_map as its default container
+ * size_value walks the tree like str_value, without writing anything
  */
-inline bool json::parse_object(node& mnode)
+inline std::size_t json::size_value(node& mnode)
 {
-    auto& it = ++context_it;
-    parse_ws();
-    mnode.assign(node::obj_t());
-
-    if (*it == '}') {
-        ++it;
-        return true;
-    }
-
-    auto& obj = mnode.get<node::obj_t>();
-    node cnode;
-    std::string key;
+    switch (mnode.type()) {
+    case node::data_k::null:
+        return 4;
 
-    while (true) {
-        parse_ws();
-        if (!parse_key(key))
-            return false;
+    case node::data_k::boolean:
+        return mnode.get<bool>() ? 4 : 5;
 
-        parse_ws();
-        if (*it == ':') {
-            ++it;
-        } else {
-            perr = error_code::miss_separator;
-            return false;
-        }
+    case node::data_k::number:
+        return detail::number_len(mnode.get<node::num_t>());
 
-        if (!parse_value(cnode))
-            return false;
+    case node::data_k::integer:
+        return detail::number_len(mnode.get<node::int_t>());
 
-        obj.emplace(std::move(key), std::move(cnode));
+    case node::data_k::uinteger:
+        return detail::number_len(mnode.get<node::uint_t>());
 
-        parse_ws();
-        if (*it == '}') {
-            ++it;
-            return true;
-        }
+    case node::data_k::string:
+        return size_string(mnode.get<node::str_t>());
+
+    case node::data_k::view:
+        return size_string(mnode.get<node::view_t>());
+
+    case node::data_k::array: {
+        auto& arr = mnode.get<node::arr_t>();
+        // brackets, and ", " between elements
+        std::size_t len = arr.empty() ? 2 : 2 * arr.size();
+        for (auto& elem : arr)
+            len += size_value(elem);
+        return len;
+    }
 
-        if (*it == ',')
-            ++it;
+    case node::data_k::object: {
+        auto& map = mnode.get<node::obj_t>();
+        // braces, ": " after keys, and ", " between members
+        std::size_t len = map.empty() ? 2 : 4 * map.size();
+        for (auto& ent : map)
+            len += size_string(ent.first) + size_value(ent.second);
+        return len;
+    }
     }
+
+    return 0;
 }
 
 /**
  * str_value is the interface to stringify root node
  */
-inline bool json::str_value(node& mnode)
+template <typename Out>
+inline bool json::str_value(Out& out, node& mnode)
 {
     switch (mnode.type()) {
     case node::data_k::array:
-        return str_array(mnode);
+        return str_array(out, mnode);
 
     case node::data_k::object:
-        return str_object(mnode);
+        return str_object(out, mnode);
 
     default:
-        return str_literal(mnode);
+        return str_literal(out, mnode);
     }
     return false;
 }
@@ -500,48 +709,55 @@ inline bool json::str_value(node& mnode)
  * because of escape charactors
  * node of string type need to be sepcially handled
  */
-inline std::string json::str_string(std::string_view src)
+template <typename Out>
+inline void json::str_string(Out& out, std::string_view src)
 {
-    std::string ret;
-
-    for (auto it = src.begin(); it != src.end(); ++it)
-        switch (*it) {
-        case '\"':
-            ret.append("\\\"");
-            break;
-
-        default:
-            ret.append(&*it, 1);
-            break;
-        }
+    detail::escape(out, src);
+}
 
-    return ret;
+/**
+ * numbers are formatted straight into the buffer of out
+ */
+template <typename Out, typename T>
+inline void json::str_number(Out& out, T val)
+{
+    char* first = out.reserve(detail::max_number_len);
+    out.commit(detail::format_number(first, val));
 }
 
 /**
  * the interface of stringing literal node
  */
-inline bool json::str_literal(node& mnode)
+template <typename Out>
+inline bool json::str_literal(Out& out, node& mnode)
 {
     switch (mnode.type()) {
     case node::data_k::null:
-        string->append("null");
+        out.append("null", 4);
         break;
 
     case node::data_k::boolean:
-        string->append(mnode.get<bool>() ? "true" : "false");
+        mnode.get<bool>() ? out.append("true", 4) : out.append("false", 5);
         break;
 
-    case node::data_k::number: {
-        auto conv = std::to_string(mnode.get<node::num_t>());
-        string->append(std::string(conv.begin(), conv.end()));
+    case node::data_k::number:
+        str_number(out, mnode.get<node::num_t>());
+        break;
+
+    case node::data_k::integer:
+        str_number(out, mnode.get<node::int_t>());
+        break;
+
+    case node::data_k::uinteger:
+        str_number(out, mnode.get<node::uint_t>());
         break;
-    }
 
     case node::data_k::string:
-        string->append("\"")
-            .append(str_string(mnode.get<node::str_t>()))
-            .append("\"");
+        str_string(out, mnode.get<node::str_t>());
+        break;
+
+    case node::data_k::view:
+        str_string(out, mnode.get<node::view_t>());
         break;
 
     default:
@@ -553,10 +769,12 @@ inline bool json::str_literal(node& mnode)
 
 /**
  * stringing node of array type
+ * a failed sink stops it after the element it failed in
  */
-inline bool json::str_array(node& mnode)
+template <typename Out>
+inline bool json::str_array(Out& out, node& mnode)
 {
-    string->append("[");
+    out.put('[');
     auto& arr = mnode.get<node::arr_t>();
 
     bool sts = false;
@@ -564,66 +782,66 @@ inline bool json::str_array(node& mnode)
 
         switch (it->type()) {
         case node::data_k::array:
-            sts = str_array(*it);
+            sts = str_array(out, *it);
             break;
 
         case node::data_k::object:
-            sts = str_object(*it);
+            sts = str_object(out, *it);
             break;
 
         default:
-            sts = str_literal(*it);
+            sts = str_literal(out, *it);
             break;
         }
 
-        if (!sts)
+        if (!sts || !out.good())
             return false;
 
         if (++it != arr.end())
-            string->append(", ");
+            out.append(", ", 2);
     }
 
-    string->append("]");
+    out.put(']');
     return true;
 }
 
 /**
  * stringing node of object node
  */
-inline bool json::str_object(node& mnode)
+template <typename Out>
+inline bool json::str_object(Out& out, node& mnode)
 {
-    string->append("{");
+    out.put('{');
     auto& map = mnode.get<node::obj_t>();
 
     bool sts = false;
     for (auto it = map.begin(); it != map.end();) {
-        string->append("\"")
-            .append(str_string(it->first))
-            .append("\": ");
+        str_string(out, it->first);
+        out.append(": ", 2);
 
         switch (it->second.type()) {
         case node::data_k::array:
-            sts = str_array(it->second);
+            sts = str_array(out, it->second);
             break;
 
         case node::data_k::object:
-            sts = str_object(it->second);
+            sts = str_object(out, it->second);
             break;
 
         default:
-            sts = str_literal(it->second);
+            sts = str_literal(out, it->second);
             break;
         }
 
-        if (!sts)
+        if (!sts || !out.good())
             return false;
 
         if (++it != map.end())
-            string->append(", ");
+            out.append(", ", 2);
     }
 
-    string->append("}");
+    out.put('}');
     return true;
 }
 
-}; // namespace mini_json
\ No newline at end of file
+}; // namespace mini_json
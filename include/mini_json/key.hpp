@@ -0,0 +1,318 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory_resource>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace mini_json {
+
+class key_pool;
+
+/**
+ * object_key is the key of an object member
+ * a key of up to inline_cap bytes is stored in the key itself, like the
+ * small buffer of std::string, and is hashed only when asked to
+ * a longer key points to an immutable record holding the precomputed
+ * hash, the length and the bytes, allocated from the resource of the key
+ * an interned record belongs to a key_pool, equal keys of a pool share
+ * one record and compare by pointer, such keys must not outlive the pool
+ * like the pmr containers, a key keeps the resource it was made with,
+ * and copying or assigning a key never makes an interned one, so a
+ * copied tree never refers to a pool
+ */
+class object_key {
+
+private:
+    struct rep {
+        std::size_t hash;
+        std::size_t len;
+    };
+
+    constexpr static std::size_t inline_cap = 15;
+    // kinds of a key that is not inline, whose kind is its length
+    constexpr static unsigned char owned = 0xFE;
+    constexpr static unsigned char pooled = 0xFF;
+
+    std::pmr::memory_resource* res = std::pmr::get_default_resource();
+    union {
+        char buf[inline_cap + 1] = {};
+        rep* ptr;
+    };
+    unsigned char kind = 0;
+
+    friend class key_pool;
+
+    static std::size_t bytes(std::size_t len) noexcept
+    {
+        return sizeof(rep) + len + 1;
+    }
+
+    static rep* make(std::pmr::memory_resource* res, std::string_view str, std::size_t hash)
+    {
+        auto* got = static_cast<rep*>(res->allocate(bytes(str.size()), alignof(rep)));
+        got->hash = hash;
+        got->len = str.size();
+
+        char* dst = reinterpret_cast<char*>(got + 1);
+        std::memcpy(dst, str.data(), str.size());
+        dst[str.size()] = '\0';
+        return got;
+    }
+
+    static std::string_view text(rep const* got) noexcept
+    {
+        return std::string_view(reinterpret_cast<char const*>(got + 1), got->len);
+    }
+
+    explicit object_key(rep* interned) noexcept
+        : ptr(interned)
+        , kind(pooled)
+    {
+    }
+
+    bool is_inline() const noexcept
+    {
+        return kind <= inline_cap;
+    }
+
+    // str must not alias a record this key owns
+    void assign(std::string_view str, std::size_t hash)
+    {
+        if (str.size() > inline_cap) {
+            ptr = make(res, str, hash);
+            kind = owned;
+        } else {
+            std::memcpy(buf, str.data(), str.size());
+            buf[str.size()] = '\0';
+            kind = static_cast<unsigned char>(str.size());
+        }
+    }
+
+    void assign(object_key const& src)
+    {
+        if (src.is_inline()) {
+            std::memcpy(buf, src.buf, sizeof(buf));
+            kind = src.kind;
+        } else {
+            assign(src.view(), src.ptr->hash);
+        }
+    }
+
+    // records owned by another resource are copied into ours
+    void take(object_key& src)
+    {
+        if (src.kind == pooled || (src.kind == owned && src.res == res)) {
+            ptr = src.ptr;
+            kind = src.kind;
+            src.kind = 0;
+            src.buf[0] = '\0';
+        } else {
+            assign(src);
+        }
+    }
+
+    void release() noexcept
+    {
+        if (kind == owned)
+            res->deallocate(ptr, bytes(ptr->len), alignof(rep));
+        kind = 0;
+        buf[0] = '\0';
+    }
+
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    static std::size_t hash(std::string_view str) noexcept
+    {
+        return std::hash<std::string_view> {}(str);
+    }
+
+    object_key() = default;
+
+    object_key(std::string_view str, allocator_type alloc = {})
+        : res(alloc.resource())
+    {
+        assign(str, str.size() > inline_cap ? hash(str) : 0);
+    }
+
+    object_key(object_key const& src, allocator_type alloc = {})
+        : res(alloc.resource())
+    {
+        assign(src);
+    }
+
+    object_key(object_key&& src, allocator_type alloc)
+        : res(alloc.resource())
+    {
+        take(src);
+    }
+
+    object_key(object_key&& src) noexcept
+        : res(src.res)
+    {
+        take(src);
+    }
+
+    object_key& operator=(object_key const& src)
+    {
+        if (this != &src) {
+            release();
+            assign(src);
+        }
+        return *this;
+    }
+
+    // the resource is not propagated, a record of another one is copied
+    object_key& operator=(object_key&& src)
+    {
+        if (this != &src) {
+            release();
+            take(src);
+        }
+        return *this;
+    }
+
+    ~object_key()
+    {
+        release();
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return res;
+    }
+
+    std::string_view view() const noexcept
+    {
+        return is_inline() ? std::string_view(buf, kind) : text(ptr);
+    }
+
+    operator std::string_view() const noexcept
+    {
+        return view();
+    }
+
+    std::size_t hash() const noexcept
+    {
+        return is_inline() ? hash(view()) : ptr->hash;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return is_inline() ? kind : ptr->len;
+    }
+
+    bool interned() const noexcept
+    {
+        return kind == pooled;
+    }
+
+    // compare against a string whose hash is already known
+    bool equals(std::string_view str, std::size_t str_hash) const noexcept
+    {
+        return is_inline() ? view() == str : ptr->hash == str_hash && text(ptr) == str;
+    }
+
+    // interned keys of one pool are equal exactly when they share a record
+    friend bool operator==(object_key const& lhs, object_key const& rhs) noexcept
+    {
+        return (lhs.kind == pooled && rhs.kind == pooled && lhs.ptr == rhs.ptr) || lhs.view() == rhs.view();
+    }
+
+    friend bool operator!=(object_key const& lhs, object_key const& rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+
+    friend bool operator==(object_key const& lhs, std::string_view rhs) noexcept
+    {
+        return lhs.view() == rhs;
+    }
+
+    friend bool operator!=(object_key const& lhs, std::string_view rhs) noexcept
+    {
+        return lhs.view() != rhs;
+    }
+
+    friend bool operator==(std::string_view lhs, object_key const& rhs) noexcept
+    {
+        return lhs == rhs.view();
+    }
+
+    friend bool operator!=(std::string_view lhs, object_key const& rhs) noexcept
+    {
+        return lhs != rhs.view();
+    }
+};
+
+/**
+ * key_pool interns the keys of one document
+ * every distinct key is stored once in a monotonic buffer
+ * and the pool hands out non-owning keys pointing to it
+ */
+class key_pool {
+
+private:
+    std::pmr::monotonic_buffer_resource buffer;
+    // open addressing table of records, kept at most half full
+    std::vector<object_key::rep*> table;
+    std::size_t count = 0;
+
+    void grow()
+    {
+        std::vector<object_key::rep*> old(table.empty() ? 64 : 2 * table.size(), nullptr);
+        old.swap(table);
+
+        std::size_t mask = table.size() - 1;
+        for (auto* got : old) {
+            if (!got)
+                continue;
+            std::size_t slot = got->hash & mask;
+            while (table[slot])
+                slot = (slot + 1) & mask;
+            table[slot] = got;
+        }
+    }
+
+public:
+    key_pool() = default;
+    key_pool(key_pool const&) = delete;
+    key_pool& operator=(key_pool const&) = delete;
+
+    object_key intern(std::string_view str)
+    {
+        if (2 * (count + 1) > table.size())
+            grow();
+
+        std::size_t hash = object_key::hash(str);
+        std::size_t mask = table.size() - 1;
+        std::size_t slot = hash & mask;
+
+        for (; table[slot]; slot = (slot + 1) & mask)
+            if (table[slot]->hash == hash && object_key::text(table[slot]) == str)
+                return object_key(table[slot]);
+
+        table[slot] = object_key::make(&buffer, str, hash);
+        ++count;
+        return object_key(table[slot]);
+    }
+
+    std::size_t size() const noexcept
+    {
+        return count;
+    }
+
+    // every key handed out before is invalidated
+    void clear() noexcept
+    {
+        table.clear();
+        count = 0;
+        buffer.release();
+    }
+};
+
+}; // namespace mini_json
@@ -0,0 +1,398 @@
+#pragma once
+#include "exception.hpp"
+#include "json.hpp"
+#include "node.hpp"
+#include "number.hpp"
+#include "scan.hpp"
+#include "string.hpp"
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace mini_json {
+
+/**
+ * lazy is a value of a document that is parsed only as it is accessed
+ * nothing is read when a lazy is made, lookups scan forward from the
+ * start of their container and skip unwanted values by their quotes
+ * and brackets only, and scalars are converted when as() is called
+ * so only the parts of the document that are visited are checked
+ * and bad_parse is thrown where one of them is not valid json
+ * a lazy refers to the input, which must outlive it
+ */
+class lazy {
+
+public:
+    class iterator;
+
+private:
+    template <typename Tar, typename Src>
+    constexpr static bool convable = std::is_constructible_v<Tar, Src>;
+
+    // first byte of the value and end of the document
+    char const* pos = nullptr;
+    char const* last = nullptr;
+
+    friend class lazy::iterator;
+    friend class pointer;
+    friend class query;
+
+    lazy(char const* pos, char const* last)
+        : pos(pos)
+        , last(last)
+    {
+    }
+
+    char kind() const
+    {
+        if (pos == last)
+            throw bad_parse();
+        return *pos;
+    }
+
+    // a scalar must be followed by whitespace, a separator or the end
+    bool delimited(char const* at) const noexcept
+    {
+        return at == last || detail::is_ws(*at) || *at == ',' || *at == ']' || *at == '}';
+    }
+
+    // the literal at pos, or throw if it is not exactly lit
+    void expect(char const* lit, std::size_t len) const
+    {
+        if (std::size_t(last - pos) < len || std::memcmp(pos, lit, len) != 0 || !delimited(pos + len))
+            throw bad_parse();
+    }
+
+    detail::number_literal number() const
+    {
+        detail::number_literal num;
+        if (!detail::scan_number(pos, last, num) || !delimited(num.end))
+            throw bad_parse();
+        return num;
+    }
+
+    // the bytes between the quotes of a string at pos
+    std::string_view raw_string() const
+    {
+        char const* close = detail::skip_string(pos + 1, last);
+        if (!close)
+            throw bad_parse();
+        return std::string_view(pos + 1, close - 1 - (pos + 1));
+    }
+
+    static std::string decode(std::string_view raw)
+    {
+        std::string out;
+        char const* it = raw.data();
+        // the closing quote is right after raw
+        if (detail::unescape(it, raw.data() + raw.size() + 1, out) != detail::string_error::non)
+            throw bad_parse();
+        return out;
+    }
+
+    static bool key_equals(std::string_view raw, std::string_view key)
+    {
+        if (raw.find('\\') == std::string_view::npos)
+            return raw == key;
+        return decode(raw) == key;
+    }
+
+public:
+    lazy() = default;
+
+    explicit lazy(std::string_view input)
+        : pos(detail::skip_ws(input.data(), input.data() + input.size()))
+        , last(input.data() + input.size())
+    {
+    }
+
+    node::data_k type() const
+    {
+        switch (kind()) {
+        case 'n':
+            return node::data_k::null;
+        case 't':
+        case 'f':
+            return node::data_k::boolean;
+        case '\"':
+            return node::data_k::string;
+        case '[':
+            return node::data_k::array;
+        case '{':
+            return node::data_k::object;
+        default: {
+            auto num = number();
+            std::int64_t ival = 0;
+            std::uint64_t uval = 0;
+            if (detail::to_int(num, ival))
+                return node::data_k::integer;
+            if (detail::to_uint(num, uval))
+                return node::data_k::uinteger;
+            return node::data_k::number;
+        }
+        }
+    }
+
+    /**
+     * convert a scalar, like node::as
+     * a string with escapes is decoded, so it cannot be a std::string_view
+     */
+    template <typename T>
+    T as() const
+    {
+        using Pure = std::decay_t<T>;
+
+        switch (kind()) {
+        case 'n':
+            expect("null", 4);
+            return detail::scalar_as<T>(nullptr);
+
+        case 't':
+        case 'f': {
+            bool val = *pos == 't';
+            val ? expect("true", 4) : expect("false", 5);
+            return detail::scalar_as<T>(val);
+        }
+
+        case '\"': {
+            auto raw = raw_string();
+            if (raw.find('\\') == std::string_view::npos)
+                return detail::scalar_as<T>(raw);
+            if constexpr (convable<T, std::string> && !std::is_same_v<Pure, std::string_view>)
+                return Pure(decode(raw));
+            break;
+        }
+
+        case '[':
+        case '{':
+            break;
+
+        default: {
+            auto num = number();
+            node::int_t ival = 0;
+            node::uint_t uval = 0;
+            node::num_t val = 0;
+
+            if (detail::to_int(num, ival))
+                return detail::scalar_as<T>(ival);
+            if (detail::to_uint(num, uval))
+                return detail::scalar_as<T>(uval);
+            if (detail::to_double(num, val))
+                return detail::scalar_as<T>(val);
+            throw bad_parse();
+        }
+        }
+
+        throw bad_as();
+    }
+
+    // number of elements or members, found by skipping all of them
+    std::size_t size() const;
+
+    iterator begin() const;
+    iterator end() const;
+
+    lazy operator[](std::size_t idx) const;
+    lazy operator[](std::string_view key) const;
+    std::optional<lazy> find(std::string_view key) const;
+
+    // the text of this value, skipped over without checking
+    std::string_view raw() const
+    {
+        char const* stop = detail::skip_value(pos, last);
+        if (!stop)
+            throw bad_parse();
+        return std::string_view(pos, stop - pos);
+    }
+
+    // parse this value and everything below it into a node
+    node to_node() const;
+};
+
+/**
+ * iterator walks the elements of an array or the members of an object
+ * for object members, key() gives the decoded key and * gives the value
+ */
+class lazy::iterator {
+
+private:
+    // start of the element or member, nullptr at the end
+    char const* it = nullptr;
+    char const* last = nullptr;
+    char const* val = nullptr;
+    std::string_view raw_key;
+    bool member = false;
+
+    friend class lazy;
+
+    iterator(char const* it, char const* last, bool member)
+        : it(it)
+        , last(last)
+        , member(member)
+    {
+        load();
+    }
+
+    // find the key and the value of the member at it
+    void load()
+    {
+        if (!it || !member) {
+            val = it;
+            return;
+        }
+
+        if (it == last || *it != '\"')
+            throw bad_parse();
+
+        raw_key = lazy(it, last).raw_string();
+        val = detail::skip_ws(raw_key.data() + raw_key.size() + 1, last);
+        if (val == last || *val != ':')
+            throw bad_parse();
+        val = detail::skip_ws(val + 1, last);
+    }
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = lazy;
+    using reference = lazy;
+    using pointer = void;
+
+    iterator() = default;
+
+    lazy operator*() const
+    {
+        return lazy(val, last);
+    }
+
+    std::string key() const
+    {
+        if (!member)
+            throw bad_get();
+        return raw_key.find('\\') == std::string_view::npos ? std::string(raw_key) : lazy::decode(raw_key);
+    }
+
+    // compare the key without decoding it when it has no escape
+    bool key_is(std::string_view key) const
+    {
+        if (!member)
+            throw bad_get();
+        return lazy::key_equals(raw_key, key);
+    }
+
+    // incrementing the end iterator throws bad_get
+    iterator& operator++()
+    {
+        if (!it)
+            throw bad_get();
+
+        char const* stop = detail::skip_value(val, last);
+        if (!stop)
+            throw bad_parse();
+
+        stop = detail::skip_ws(stop, last);
+        if (stop != last && *stop == (member ? '}' : ']')) {
+            it = val = nullptr;
+            return *this;
+        }
+
+        if (stop == last || *stop != ',')
+            throw bad_parse();
+
+        it = detail::skip_ws(stop + 1, last);
+        load();
+        return *this;
+    }
+
+    iterator operator++(int)
+    {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(iterator const& rhs) const noexcept
+    {
+        return it == rhs.it;
+    }
+
+    bool operator!=(iterator const& rhs) const noexcept
+    {
+        return it != rhs.it;
+    }
+};
+
+inline lazy::iterator lazy::begin() const
+{
+    char type = kind();
+    if (type != '[' && type != '{')
+        throw bad_get();
+
+    char const* it = detail::skip_ws(pos + 1, last);
+    if (it != last && *it == (type == '[' ? ']' : '}'))
+        return iterator(nullptr, last, type == '{');
+    return iterator(it, last, type == '{');
+}
+
+inline lazy::iterator lazy::end() const
+{
+    char type = kind();
+    if (type != '[' && type != '{')
+        throw bad_get();
+    return iterator(nullptr, last, type == '{');
+}
+
+inline std::size_t lazy::size() const
+{
+    return static_cast<std::size_t>(std::distance(begin(), end()));
+}
+
+inline lazy lazy::operator[](std::size_t idx) const
+{
+    if (kind() != '[')
+        throw bad_get();
+
+    for (auto it = begin(), ed = end(); it != ed; ++it, --idx)
+        if (idx == 0)
+            return *it;
+
+    throw std::out_of_range("mini_json::lazy : index out of range");
+}
+
+inline std::optional<lazy> lazy::find(std::string_view key) const
+{
+    if (kind() != '{')
+        throw bad_get();
+
+    for (auto it = begin(), ed = end(); it != ed; ++it)
+        if (it.key_is(key))
+            return *it;
+
+    return std::nullopt;
+}
+
+inline lazy lazy::operator[](std::string_view key) const
+{
+    if (auto got = find(key); got)
+        return *got;
+
+    throw std::out_of_range("mini_json::lazy : key not found");
+}
+
+inline node lazy::to_node() const
+{
+    auto text = raw();
+    auto doc = json::from_view(text);
+    node* got = doc.parse();
+    if (!got)
+        throw bad_parse();
+    return std::move(*got);
+}
+
+}; // namespace mini_json
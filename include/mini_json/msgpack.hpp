@@ -0,0 +1,410 @@
+#pragma once
+#include "binary.hpp"
+#include "json.hpp"
+#include "node.hpp"
+#include "sink.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace mini_json {
+
+/**
+ * msgpack encodes a node to messagepack and decodes it back,
+ * or into the events of json::parse(handler), so no number
+ * is formatted and no string is escaped on the way
+ * integers take their smallest form, doubles are always float64,
+ * bin is decoded as a string and ext is invalid
+ * strings passed to a handler refer to the input
+ */
+class msgpack {
+
+public:
+    using error_code = json::error_code;
+
+private:
+    char const* it = nullptr;
+    char const* end = nullptr;
+    error_code err = error_code::non;
+
+    bool fail(error_code code) noexcept
+    {
+        err = code;
+        return false;
+    }
+
+    template <typename T, typename Out>
+    static void put_be(Out& out, char tag, T val)
+    {
+        char* first = out.reserve(1 + sizeof(T));
+        *first = tag;
+        out.commit(detail::store_be(first + 1, val));
+    }
+
+    template <typename Out>
+    static void put_uint(Out& out, std::uint64_t val)
+    {
+        if (val < 0x80)
+            out.put(static_cast<char>(val));
+        else if (val <= 0xFF)
+            put_be(out, '\xCC', std::uint8_t(val));
+        else if (val <= 0xFFFF)
+            put_be(out, '\xCD', std::uint16_t(val));
+        else if (val <= 0xFFFFFFFF)
+            put_be(out, '\xCE', std::uint32_t(val));
+        else
+            put_be(out, '\xCF', val);
+    }
+
+    template <typename Out>
+    static void put_int(Out& out, std::int64_t val)
+    {
+        if (val >= 0)
+            put_uint(out, std::uint64_t(val));
+        else if (val >= -32)
+            out.put(static_cast<char>(val));
+        else if (val >= INT8_MIN)
+            put_be(out, '\xD0', std::uint8_t(val));
+        else if (val >= INT16_MIN)
+            put_be(out, '\xD1', std::uint16_t(val));
+        else if (val >= INT32_MIN)
+            put_be(out, '\xD2', std::uint32_t(val));
+        else
+            put_be(out, '\xD3', std::uint64_t(val));
+    }
+
+    // the head of a str, array or map, fix is the tag of the fixed form
+    template <typename Out>
+    static void put_head(Out& out, std::size_t len, unsigned char fix, std::size_t fix_max, char tag8, char tag16)
+    {
+        if (len <= fix_max)
+            out.put(static_cast<char>(fix | len));
+        else if (tag8 && len <= 0xFF)
+            put_be(out, tag8, std::uint8_t(len));
+        else if (len <= 0xFFFF)
+            put_be(out, tag16, std::uint16_t(len));
+        else
+            put_be(out, char(tag16 + 1), std::uint32_t(len));
+    }
+
+    template <typename Out>
+    static void put_string(Out& out, std::string_view str)
+    {
+        put_head(out, str.size(), 0xA0, 31, '\xD9', '\xDA');
+        out.append(str);
+    }
+
+    template <typename Out>
+    static void encode_value(Out& out, node const& mnode)
+    {
+        switch (mnode.type()) {
+        case node::data_k::null:
+            out.put('\xC0');
+            break;
+
+        case node::data_k::boolean:
+            out.put(mnode.get<bool>() ? '\xC3' : '\xC2');
+            break;
+
+        case node::data_k::number: {
+            char* first = out.reserve(9);
+            *first = '\xCB';
+            out.commit(detail::store_double(first + 1, mnode.get<node::num_t>()));
+            break;
+        }
+
+        case node::data_k::integer:
+            put_int(out, mnode.get<node::int_t>());
+            break;
+
+        case node::data_k::uinteger:
+            put_uint(out, mnode.get<node::uint_t>());
+            break;
+
+        case node::data_k::string:
+            put_string(out, mnode.get<node::str_t>());
+            break;
+
+        case node::data_k::view:
+            put_string(out, mnode.get<node::view_t>());
+            break;
+
+        case node::data_k::array: {
+            auto& arr = mnode.get<node::arr_t>();
+            put_head(out, arr.size(), 0x90, 15, 0, '\xDC');
+            for (auto& elem : arr)
+                encode_value(out, elem);
+            break;
+        }
+
+        case node::data_k::object: {
+            auto& map = mnode.get<node::obj_t>();
+            put_head(out, map.size(), 0x80, 15, 0, '\xDE');
+            for (auto& ent : map) {
+                put_string(out, ent.first);
+                encode_value(out, ent.second);
+            }
+            break;
+        }
+        }
+    }
+
+    // read the next size bytes, or fail on truncated input
+    bool take(std::size_t size, char const*& got) noexcept
+    {
+        if (std::size_t(end - it) < size)
+            return fail(error_code::invalid_value);
+        got = it;
+        it += size;
+        return true;
+    }
+
+    template <typename T>
+    bool take_be(T& val) noexcept
+    {
+        char const* got;
+        if (!take(sizeof(T), got))
+            return false;
+        val = detail::load_be<T>(got);
+        return true;
+    }
+
+    // the length of a str, bin, array or map, for tags with a length field
+    bool take_len(unsigned char tag, std::size_t& len) noexcept
+    {
+        std::uint8_t l8 = 0;
+        std::uint16_t l16 = 0;
+        std::uint32_t l32 = 0;
+
+        switch (tag) {
+        case 0xC4:
+        case 0xD9:
+            if (!take_be(l8))
+                return false;
+            len = l8;
+            return true;
+
+        case 0xC5:
+        case 0xDA:
+        case 0xDC:
+        case 0xDE:
+            if (!take_be(l16))
+                return false;
+            len = l16;
+            return true;
+
+        default:
+            if (!take_be(l32))
+                return false;
+            len = l32;
+            return true;
+        }
+    }
+
+    bool check(bool go) noexcept
+    {
+        return go || fail(error_code::aborted);
+    }
+
+    template <typename Handler>
+    bool decode_string(Handler& handler, std::size_t len, bool key)
+    {
+        char const* got;
+        if (!take(len, got))
+            return false;
+
+        std::string_view str(got, len);
+        return check(key ? handler.key(str) : handler.string(str));
+    }
+
+    template <typename Handler>
+    bool decode_array(Handler& handler, std::size_t len)
+    {
+        if (!check(handler.start_array()))
+            return false;
+        detail::reserve(handler, std::min<std::size_t>(len, end - it));
+
+        for (std::size_t i = 0; i < len; ++i)
+            if (!decode_value(handler))
+                return false;
+
+        return check(handler.end_array(len));
+    }
+
+    template <typename Handler>
+    bool decode_map(Handler& handler, std::size_t len)
+    {
+        if (!check(handler.start_object()))
+            return false;
+        detail::reserve(handler, std::min<std::size_t>(len, (end - it) / 2));
+
+        for (std::size_t i = 0; i < len; ++i) {
+            if (it == end)
+                return fail(error_code::invalid_value);
+
+            auto tag = static_cast<unsigned char>(*it++);
+            std::size_t klen = tag & 0x1F;
+            if ((tag & 0xE0) != 0xA0 && (tag < 0xD9 || tag > 0xDB))
+                return fail(error_code::invalid_key);
+            if ((tag & 0xE0) != 0xA0 && !take_len(tag, klen))
+                return false;
+
+            if (!decode_string(handler, klen, true) || !decode_value(handler))
+                return false;
+        }
+
+        return check(handler.end_object(len));
+    }
+
+    template <typename Handler>
+    bool decode_value(Handler& handler)
+    {
+        if (it == end)
+            return fail(error_code::expect_value);
+
+        auto tag = static_cast<unsigned char>(*it++);
+        std::size_t len = 0;
+
+        if (tag < 0x80)
+            return check(handler.integer(tag));
+        if (tag >= 0xE0)
+            return check(handler.integer(std::int8_t(tag)));
+        if (tag >= 0xA0 && tag <= 0xBF)
+            return decode_string(handler, tag & 0x1F, false);
+        if (tag >= 0x90 && tag <= 0x9F)
+            return decode_array(handler, tag & 0x0F);
+        if (tag >= 0x80 && tag <= 0x8F)
+            return decode_map(handler, tag & 0x0F);
+
+        switch (tag) {
+        case 0xC0:
+            return check(handler.null());
+        case 0xC2:
+        case 0xC3:
+            return check(handler.boolean(tag == 0xC3));
+
+        case 0xCA: {
+            char const* got;
+            return take(4, got) && check(handler.number(detail::load_float(got)));
+        }
+        case 0xCB: {
+            char const* got;
+            return take(8, got) && check(handler.number(detail::load_double(got)));
+        }
+
+        case 0xCC: {
+            std::uint8_t val;
+            return take_be(val) && check(handler.integer(val));
+        }
+        case 0xCD: {
+            std::uint16_t val;
+            return take_be(val) && check(handler.integer(val));
+        }
+        case 0xCE: {
+            std::uint32_t val;
+            return take_be(val) && check(handler.integer(val));
+        }
+        case 0xCF: {
+            // like the text parser, an integer that fits stays signed
+            std::uint64_t val;
+            if (!take_be(val))
+                return false;
+            if (val <= std::uint64_t(std::numeric_limits<node::int_t>::max()))
+                return check(handler.integer(node::int_t(val)));
+            return check(handler.uinteger(val));
+        }
+
+        case 0xD0: {
+            std::uint8_t val;
+            return take_be(val) && check(handler.integer(std::int8_t(val)));
+        }
+        case 0xD1: {
+            std::uint16_t val;
+            return take_be(val) && check(handler.integer(std::int16_t(val)));
+        }
+        case 0xD2: {
+            std::uint32_t val;
+            return take_be(val) && check(handler.integer(std::int32_t(val)));
+        }
+        case 0xD3: {
+            std::uint64_t val;
+            return take_be(val) && check(handler.integer(std::int64_t(val)));
+        }
+
+        case 0xC4:
+        case 0xC5:
+        case 0xC6:
+        case 0xD9:
+        case 0xDA:
+        case 0xDB:
+            return take_len(tag, len) && decode_string(handler, len, false);
+
+        case 0xDC:
+        case 0xDD:
+            return take_len(tag, len) && decode_array(handler, len);
+
+        case 0xDE:
+        case 0xDF:
+            return take_len(tag, len) && decode_map(handler, len);
+
+        default:
+            // 0xC1 is never used, ext types have no node to map to
+            return fail(error_code::invalid_value);
+        }
+    }
+
+public:
+    /**
+     * write root to sink through a small fixed buffer
+     */
+    template <typename Sink>
+    bool encode(node const& root, Sink& sink)
+    {
+        err = error_code::non;
+        detail::writer<Sink> out(sink);
+        encode_value(out, root);
+        return out.flush() || fail(error_code::write_failed);
+    }
+
+    std::string encode(node const& root)
+    {
+        std::string ret;
+        string_sink sink(ret);
+        encode(root, sink);
+        return ret;
+    }
+
+    /**
+     * decode one value that spans the whole input into events,
+     * like json::parse(handler)
+     */
+    template <typename Handler>
+    bool decode(std::string_view input, Handler& handler)
+    {
+        it = input.data();
+        end = it + input.size();
+        err = error_code::non;
+
+        if (!decode_value(handler))
+            return false;
+
+        return it == end || fail(error_code::root_singular);
+    }
+
+    // out is left unspecified when decoding fails
+    bool decode(std::string_view input, node& out)
+    {
+        detail::node_builder builder(out);
+        return decode(input, builder);
+    }
+
+    error_code errp() const noexcept
+    {
+        return err;
+    }
+};
+
+}; // namespace mini_json
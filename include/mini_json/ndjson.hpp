@@ -0,0 +1,105 @@
+#pragma once
+#include "json.hpp"
+#include "pool.hpp"
+#include "scan.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mini_json {
+
+/**
+ * ndjson parses the lines of newline delimited json on a pool of worker
+ * threads and hands the nodes over in input order
+ * documents are parsed in place, and every worker keeps its own json
+ * object, so its parsing buffers are reused across documents and calls
+ * while the nodes are allocated from the default resource, so they can
+ * be kept after the callback returns
+ * the workers are started once and sleep between batches, the next
+ * batch_size documents are found while the workers parse the current
+ * ones, which bounds the memory of nodes not handed over yet
+ */
+class ndjson {
+
+public:
+    using error_code = json::error_code;
+
+    constexpr static std::size_t batch_size = detail::parse_pool::batch_size;
+    // documents a worker takes at once
+    constexpr static std::size_t grain = detail::parse_pool::grain;
+
+private:
+    using document = detail::parse_pool::document;
+
+    detail::parse_pool pool;
+
+public:
+    /**
+     * threads is the number of workers, zero means one per core
+     */
+    explicit ndjson(std::size_t threads = 0)
+        : pool(threads ? threads : std::max(1u, std::thread::hardware_concurrency()))
+    {
+    }
+
+    /**
+     * parse every line of input as a document, blank lines are skipped
+     * and call callback(node&) on each in input order,
+     * the callback may move the node away
+     * parsing stops at the first invalid document, the ones before it
+     * have all been handed over, errp and errline tell what and where
+     */
+    template <typename Callback>
+    bool parse(std::string_view input, Callback&& callback)
+    {
+        char const* it = input.data();
+        char const* end = it + input.size();
+        std::size_t line = 0;
+
+        auto split = [&](std::vector<document>& docs, bool& last) {
+            for (; it != end && docs.size() < batch_size; ++line) {
+                auto* eol = static_cast<char const*>(std::memchr(it, '\n', end - it));
+                char const* stop = eol ? eol : end;
+
+                if (detail::skip_ws(it, stop) != stop)
+                    docs.push_back({ std::string_view(it, stop - it), line });
+                it = eol ? eol + 1 : end;
+            }
+
+            last = it == end;
+            return true;
+        };
+
+        return pool.run(split, callback);
+    }
+
+    /**
+     * parse every document of input and append them to out
+     */
+    bool parse(std::string_view input, std::vector<node>& out)
+    {
+        return parse(input, [&out](node& doc) { out.push_back(std::move(doc)); });
+    }
+
+    error_code errp() const noexcept
+    {
+        return pool.errp();
+    }
+
+    // zero-based line of the invalid document
+    std::size_t errline() const noexcept
+    {
+        return pool.errpos();
+    }
+
+    std::size_t threads() const noexcept
+    {
+        return pool.size();
+    }
+};
+
+}; // namespace mini_json
@@ -1,9 +1,14 @@
 #pragma once
 #include "../mini_mpf/type_umap.hpp"
 #include "exception.hpp"
+#include "object.hpp"
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -12,6 +17,53 @@
 
 namespace mini_json {
 
+namespace detail {
+
+// range_value is the element type of anything with begin and end
+template <typename T, typename = void>
+struct range_value {
+    using type = void;
+};
+
+template <typename T>
+struct range_value<T, std::void_t<decltype(std::begin(std::declval<T&>()), std::end(std::declval<T&>()))>> {
+    using type = std::decay_t<decltype(*std::begin(std::declval<T&>()))>;
+};
+
+class node_builder;
+
+/**
+ * scalar_as converts a scalar read by lazy, tape or snapshot to T
+ * like node::as does, or throws bad_as if T cannot be made from it
+ * a null never becomes a string, as string_view(nullptr) is undefined
+ */
+template <typename T, typename Src>
+inline T scalar_as(Src val)
+{
+    using Pure = std::decay_t<T>;
+
+    if constexpr (std::is_null_pointer_v<Src>) {
+        constexpr bool string_like = std::is_convertible_v<Pure, std::string_view> && !std::is_null_pointer_v<Pure>;
+        if constexpr (std::is_constructible_v<T, Src> && !string_like)
+            return Pure(val);
+    } else if constexpr (std::is_constructible_v<T, Src>) {
+        return Pure(val);
+    }
+
+    throw bad_as();
+}
+
+}; // namespace detail
+
+/**
+ * node holds one json value
+ * containers and strings are std::pmr types, so a tree can be allocated
+ * from any memory resource, such as the arena of a json object
+ * a node moved out of such a tree still uses that resource
+ * while a copied node uses the default resource
+ * a view node refers to the context of the json it was parsed from
+ * and copying it materializes the string
+ */
 class node {
 
 private:
@@ -24,14 +76,40 @@ private:
     template <typename T1, typename T2>
     constexpr static bool is_same = std::is_same_v<T1, T2>;
 
-    using obj_t = std::unordered_map<std::string, node>;
-    using arr_t = std::vector<node>;
-    using nil_t = std::nullptr_t;
-    using str_t = std::string;
-    using num_t = double;
+    template <typename T>
+    using range_value_t = typename detail::range_value<T>::type;
+
+    // get also takes the std types the containers and strings used to be,
+    // but returns the pmr type that is stored, so get<std::string>() is a
+    // str_t& and cannot bind to std::string&, as<std::string>() copies instead
+    template <typename T>
+    using stored_t = std::conditional_t<is_same<T, std::string>, std::pmr::string,
+        std::conditional_t<is_same<T, std::vector<node>>, std::pmr::vector<node>,
+            std::conditional_t<is_same<T, std::unordered_map<std::string, node>>, object<node>, T>>>;
+
+    // a std::string_view is returned by value, so it can refer to either kind of string
+    template <typename T>
+    using get_t = std::conditional_t<is_same<stored_t<T>, std::string_view>, std::string_view, stored_t<T>&>;
+
+    template <typename T>
+    using get_const_t = std::conditional_t<is_same<stored_t<T>, std::string_view>, std::string_view, stored_t<T> const&>;
 
 public:
     friend class json;
+    friend class pointer;
+    friend class msgpack;
+    friend class cbor;
+    friend class snapshot;
+    friend class detail::node_builder;
+
+    using obj_t = object<node>;
+    using arr_t = std::pmr::vector<node>;
+    using nil_t = std::nullptr_t;
+    using str_t = std::pmr::string;
+    using num_t = double;
+    using int_t = std::int64_t;
+    using uint_t = std::uint64_t;
+    using view_t = std::string_view;
 
     enum class data_k {
         null,
@@ -40,6 +118,9 @@ public:
         string,
         number,
         boolean,
+        integer,
+        uinteger,
+        view,
     };
 
     using data_t = mini_mpf::type_umap<data_k,
@@ -48,28 +129,57 @@ public:
         obj_t,
         str_t,
         num_t,
-        bool>;
+        bool,
+        int_t,
+        uint_t,
+        view_t>;
 
 private:
     data_t::forward<std::variant> data;
 
-    data_k type()
+    data_k type() const noexcept
     {
         return static_cast<data_k>(data.index());
     }
 
+    // copy or move the elements of a foreign container
+    template <typename Cont, typename T>
+    static Cont assign_range(T&& elem)
+    {
+        if constexpr (std::is_rvalue_reference_v<T&&>)
+            return Cont(std::make_move_iterator(std::begin(elem)), std::make_move_iterator(std::end(elem)));
+        else
+            return Cont(std::begin(elem), std::end(elem));
+    }
+
+    // a copy never refers to the context of a json
+    void copy(node const& src)
+    {
+        if (auto const* view = std::get_if<view_t>(&src.data); view)
+            data = str_t(*view);
+        else
+            data = src.data;
+    }
+
 public:
     template <typename T>
     constexpr void assign(T&& elem)
     {
         using Pure = std::decay_t<T>;
-        if constexpr (data_t::find_if<T>()) {
+        if constexpr (is_same<view_t, Pure>) {
+            // only the parser creates views, a given one is always copied
+            data = str_t(elem);
+        } else if constexpr (data_t::find_if<T>()) {
             data = std::forward<T>(elem);
         } else {
             if constexpr (is_same<nil_t, Pure>) {
                 data = nil_t {};
             } else if constexpr (is_same<bool, Pure>) {
                 data = elem;
+            } else if constexpr (std::is_integral_v<Pure> && std::is_signed_v<Pure>) {
+                data = data_t::at<data_k::integer>(elem);
+            } else if constexpr (std::is_integral_v<Pure>) {
+                data = data_t::at<data_k::uinteger>(elem);
             } else if constexpr (is_num<Pure>) {
                 data = data_t::at<data_k::number>(elem);
             } else if constexpr (convable<str_t, T>) {
@@ -78,31 +188,52 @@ public:
                 data = arr_t(std::forward<T>(elem));
             } else if constexpr (convable<obj_t, T>) {
                 data = obj_t(std::forward<T>(elem));
+            } else if constexpr (is_same<node, range_value_t<Pure>>) {
+                // such as std::vector<node>
+                data = assign_range<arr_t>(std::forward<T>(elem));
+            } else if constexpr (convable<obj_t::value_type, range_value_t<Pure>>) {
+                // such as std::unordered_map<std::string, node>
+                data = assign_range<obj_t>(std::forward<T>(elem));
             } else {
                 throw bad_assign();
             }
         }
     }
 
+    /**
+     * get returns a reference to the data, which must be held as T
+     * std::string, std::vector<node> and std::unordered_map<std::string, node>
+     * refer to str_t, arr_t and obj_t
+     * std::string_view reads a string whether it is held as str_t or view_t
+     */
     template <typename T>
-    constexpr T& get()
+    constexpr get_t<std::decay_t<T>> get()
     {
-        using Pure = std::decay_t<T>;
+        using Pure = stored_t<std::decay_t<T>>;
         static_assert(data_t::find_if<Pure>(), "mini_json::node::get : invalid type");
 
-        if (T* got = std::get_if<Pure>(&data); got)
-            return *got;
+        if constexpr (is_same<Pure, view_t>) {
+            return std::as_const(*this).template get<view_t>();
+        } else {
+            if (Pure* got = std::get_if<Pure>(&data); got)
+                return *got;
 
-        throw bad_get();
+            throw bad_get();
+        }
     }
 
     template <typename T>
-    constexpr T const& get() const
+    constexpr get_const_t<std::decay_t<T>> get() const
     {
-        using Pure = std::decay_t<T>;
+        using Pure = stored_t<std::decay_t<T>>;
         static_assert(data_t::find_if<Pure>(), "mini_json::node::get : invalid type");
 
-        if (T const* got = std::get_if<Pure>(&data); got)
+        if constexpr (is_same<Pure, view_t>) {
+            if (str_t const* got = std::get_if<str_t>(&data); got)
+                return view_t(*got);
+        }
+
+        if (Pure const* got = std::get_if<Pure>(&data); got)
             return *got;
 
         throw bad_get();
@@ -124,6 +255,9 @@ public:
         CHECK_AND_HANDLE(str_t);
         CHECK_AND_HANDLE(num_t);
         CHECK_AND_HANDLE(bool);
+        CHECK_AND_HANDLE(int_t);
+        CHECK_AND_HANDLE(uint_t);
+        CHECK_AND_HANDLE(view_t);
 
         throw bad_as();
     }
@@ -139,38 +273,45 @@ public:
 
     node(node& src)
     {
-        auto tmp = src.data;
-        data.swap(tmp);
+        copy(src);
     }
 
     node(node const& src)
     {
-        auto tmp = src.data;
-        data.swap(tmp);
+        copy(src);
     }
 
-    node(node&& src)
+    // moves must be noexcept, or growing an arr_t copies every element
+    node(node&& src) noexcept
     {
         data.swap(src.data);
         src.data = nullptr;
     }
 
+    // containers from different resources must not be swapped
+    // so assignment goes through the variant instead
     node& operator=(node const& src)
     {
         if (this == &src)
             return *this;
 
-        auto tmp = src.data;
-        data.swap(tmp);
+        copy(src);
         return *this;
     }
 
-    node& operator=(node&& src)
+    /**
+     * moving the data of src onto a container of the same kind would
+     * copy it element by element when their resources differ, so the
+     * old data goes first and this node takes over the resource of src
+     * like a moved-to node does, and moving never allocates
+     */
+    node& operator=(node&& src) noexcept
     {
         if (this == &src)
             return *this;
 
-        data.swap(src.data);
+        data = nullptr;
+        data = std::move(src.data);
         src.data = nullptr;
         return *this;
     }
@@ -0,0 +1,307 @@
+#pragma once
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+#if !defined(__cpp_lib_to_chars)
+#include <cstdio>
+#include <locale>
+#include <sstream>
+#include <string>
+#endif
+
+namespace mini_json::detail {
+
+/**
+ * number_literal holds the pieces of a json number literal
+ * the value is mantissa * 10^exponent, mantissa keeps as many leading
+ * digits as fit in uint64_t and truncated tells if any non-zero was lost
+ */
+struct number_literal {
+    char const* begin = nullptr;
+    char const* end = nullptr;
+    std::uint64_t mantissa = 0;
+    std::int64_t exponent = 0;
+    bool negative = false;
+    bool integral = true;
+    bool truncated = false;
+};
+
+inline bool is_digit(char ch) noexcept
+{
+    return ch >= '0' && ch <= '9';
+}
+
+/**
+ * scan_number checks the json number grammar on [it, end)
+ *     -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+ * which rejects the forms strtod accepts but json does not
+ * such as a leading '+', leading zeros, hex floats, inf and nan
+ */
+inline bool scan_number(char const* it, char const* end, number_literal& num) noexcept
+{
+    num = number_literal {};
+    num.begin = it;
+
+    if (it != end && *it == '-') {
+        num.negative = true;
+        ++it;
+    }
+
+    if (it == end || !is_digit(*it))
+        return false;
+
+    std::uint64_t mant = 0;
+    std::int64_t exp = 0;
+
+    // mantissa keeps digits as long as it does not overflow
+    auto fits = [&mant](char ch) {
+        constexpr std::uint64_t limit = std::numeric_limits<std::uint64_t>::max() / 10;
+        return mant < limit || (mant == limit && std::uint64_t(ch - '0') <= std::numeric_limits<std::uint64_t>::max() % 10);
+    };
+
+    if (*it == '0') {
+        ++it;
+        if (it != end && is_digit(*it))
+            return false;
+    } else {
+        for (; it != end && is_digit(*it); ++it) {
+            if (fits(*it)) {
+                mant = mant * 10 + std::uint64_t(*it - '0');
+            } else {
+                num.truncated |= *it != '0';
+                ++exp;
+            }
+        }
+    }
+
+    if (it != end && *it == '.') {
+        num.integral = false;
+        if (++it == end || !is_digit(*it))
+            return false;
+
+        for (; it != end && is_digit(*it); ++it) {
+            if (fits(*it)) {
+                // leading zeros of 0.000123 only move the exponent
+                mant = mant * 10 + std::uint64_t(*it - '0');
+                --exp;
+            } else {
+                num.truncated |= *it != '0';
+            }
+        }
+    }
+
+    if (it != end && (*it == 'e' || *it == 'E')) {
+        num.integral = false;
+        bool neg = false;
+        if (++it != end && (*it == '+' || *it == '-'))
+            neg = *it++ == '-';
+
+        if (it == end || !is_digit(*it))
+            return false;
+
+        // saturate, anything beyond is zero or infinity anyway
+        std::int64_t val = 0;
+        for (; it != end && is_digit(*it); ++it)
+            if (val < 100000)
+                val = val * 10 + (*it - '0');
+
+        exp += neg ? -val : val;
+    }
+
+    num.end = it;
+    num.mantissa = mant;
+    num.exponent = exp;
+    return true;
+}
+
+/**
+ * to_int converts an integral literal that fits in int64_t
+ * -0 is left to to_double, which keeps its sign
+ */
+inline bool to_int(number_literal const& num, std::int64_t& out) noexcept
+{
+    constexpr std::uint64_t max = std::uint64_t(std::numeric_limits<std::int64_t>::max());
+
+    if (!num.integral || num.truncated || num.exponent != 0)
+        return false;
+
+    if (num.negative && num.mantissa == 0)
+        return false;
+
+    if (num.negative ? num.mantissa > max + 1 : num.mantissa > max)
+        return false;
+
+    // negate in unsigned arithmetic so that -2^63 does not overflow
+    out = static_cast<std::int64_t>(num.negative ? ~num.mantissa + 1 : num.mantissa);
+    return true;
+}
+
+/**
+ * to_uint converts a non-negative integral literal that fits in uint64_t
+ */
+inline bool to_uint(number_literal const& num, std::uint64_t& out) noexcept
+{
+    if (!num.integral || num.truncated || num.exponent != 0 || num.negative)
+        return false;
+
+    out = num.mantissa;
+    return true;
+}
+
+/**
+ * to_double converts a scanned literal with correct rounding
+ * the fast path is exact when both the mantissa and the power of ten
+ * are exactly representable, the rest go through std::from_chars
+ * which is locale independent (unlike strtod)
+ */
+inline bool to_double(number_literal const& num, double& out) noexcept
+{
+    constexpr double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    constexpr std::uint64_t max_exact = std::uint64_t(1) << 53;
+
+    if (num.mantissa == 0 && !num.truncated) {
+        out = num.negative ? -0.0 : 0.0;
+        return true;
+    }
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    if (!num.truncated && num.mantissa <= max_exact) {
+        auto mant = num.mantissa;
+        auto exp = num.exponent;
+
+        // 123e25 is the exact 1230000e20, shift digits into the mantissa
+        while (exp > 22 && mant * 10 <= max_exact) {
+            mant *= 10;
+            --exp;
+        }
+
+        if (exp >= -22 && exp <= 22) {
+            double val = double(mant);
+            val = exp < 0 ? val / pow10[-exp] : val * pow10[exp];
+            out = num.negative ? -val : val;
+            return true;
+        }
+    }
+#endif
+
+#if defined(__cpp_lib_to_chars)
+    double val = 0;
+    auto [ptr, ec] = std::from_chars(num.begin, num.end, val);
+    if (ec == std::errc::result_out_of_range) {
+        // underflow rounds to zero, overflow is not representable
+        if (num.exponent > 0)
+            return false;
+        val = num.negative ? -0.0 : 0.0;
+    } else if (ec != std::errc() || ptr != num.end) {
+        return false;
+    }
+#else
+    std::istringstream ss(std::string(num.begin, num.end));
+    ss.imbue(std::locale::classic());
+    double val = 0;
+    if (!(ss >> val))
+        return false;
+#endif
+
+    if (val == std::numeric_limits<double>::infinity() || val == -std::numeric_limits<double>::infinity())
+        return false;
+
+    out = val;
+    return true;
+}
+
+/**
+ * emit_number passes a scanned literal to the narrowest handler event
+ * that keeps it, integer, then uinteger, then number
+ * it returns false if the literal fits none of them, without calling
+ * handler, otherwise go is set to what the handler returned
+ */
+template <typename Handler>
+inline bool emit_number(number_literal const& num, Handler& handler, bool& go)
+{
+    std::int64_t ival = 0;
+    std::uint64_t uval = 0;
+    double val = 0;
+
+    if (to_int(num, ival))
+        go = handler.integer(ival);
+    else if (to_uint(num, uval))
+        go = handler.uinteger(uval);
+    else if (to_double(num, val))
+        go = handler.number(val);
+    else
+        return false;
+
+    return true;
+}
+
+// enough room for any formatted int64_t, uint64_t or double
+constexpr std::size_t max_number_len = 32;
+
+/**
+ * format_number writes val to out, which has max_number_len bytes
+ * and returns the end of what was written
+ * doubles use the shortest form that reads back to the same value
+ * json has no inf or nan, so they are written as null
+ */
+template <typename T>
+inline char* format_number(char* out, T val) noexcept
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        if (val != val || val == std::numeric_limits<T>::infinity() || val == -std::numeric_limits<T>::infinity()) {
+            out[0] = 'n', out[1] = 'u', out[2] = 'l', out[3] = 'l';
+            return out + 4;
+        }
+
+#if defined(__cpp_lib_to_chars)
+        return std::to_chars(out, out + max_number_len, val).ptr;
+#else
+        // max_digits10 digits always round trip, keep a '.' whatever the locale is
+        int len = std::snprintf(out, max_number_len, "%.*g", std::numeric_limits<T>::max_digits10, double(val));
+        for (int i = 0; i < len; ++i)
+            if (out[i] == ',')
+                out[i] = '.';
+        return out + len;
+#endif
+    } else {
+        return std::to_chars(out, out + max_number_len, val).ptr;
+    }
+}
+
+/**
+ * number_len is the length format_number writes for val
+ * integers count their digits, doubles have to be formatted
+ */
+template <typename T>
+inline std::size_t number_len(T val) noexcept
+{
+    if constexpr (std::is_floating_point_v<T>) {
+        char buf[max_number_len];
+        return static_cast<std::size_t>(format_number(buf, val) - buf);
+    } else {
+        std::make_unsigned_t<T> mag = val;
+        std::size_t len = 1;
+        if constexpr (std::is_signed_v<T>) {
+            if (val < 0) {
+                mag = std::make_unsigned_t<T>(0) - mag;
+                ++len;
+            }
+        }
+
+        for (; mag >= 10; mag /= 10)
+            ++len;
+        return len;
+    }
+}
+
+}; // namespace mini_json::detail
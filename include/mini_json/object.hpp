@@ -0,0 +1,266 @@
+#pragma once
+#include "key.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace mini_json {
+
+/**
+ * object is the container behind json objects
+ * entries are stored contiguously in insertion order, so objects are
+ * printed in the order they were parsed or filled
+ * small objects are searched linearly comparing keys, and an open
+ * addressing index of positions by key hash is only built once an
+ * object grows past index_threshold keys
+ * like std::vector, inserting or erasing invalidates iterators
+ * and keys must not be modified through an iterator
+ */
+template <typename Node>
+class object {
+
+public:
+    using key_type = object_key;
+    using mapped_type = Node;
+    using value_type = std::pair<key_type, Node>;
+    using allocator_type = std::pmr::polymorphic_allocator<value_type>;
+    using size_type = std::size_t;
+    using iterator = typename std::pmr::vector<value_type>::iterator;
+    using const_iterator = typename std::pmr::vector<value_type>::const_iterator;
+
+    constexpr static size_type index_threshold = 16;
+
+private:
+    constexpr static size_type npos = size_type(-1);
+
+    std::pmr::vector<value_type> entries;
+    // positions plus one, zero marks an empty slot
+    std::pmr::vector<std::uint32_t> index;
+
+    static std::size_t hash_of(std::string_view key) noexcept
+    {
+        return object_key::hash(key);
+    }
+
+    static std::size_t hash_of(object_key const& key) noexcept
+    {
+        return key.hash();
+    }
+
+    // key is only hashed once there is an index to probe
+    template <typename Key>
+    size_type search(Key const& key) const noexcept
+    {
+        if (index.empty()) {
+            for (size_type i = 0; i < entries.size(); ++i)
+                if (entries[i].first == key)
+                    return i;
+            return npos;
+        }
+
+        std::size_t hash = hash_of(key);
+        size_type mask = index.size() - 1;
+        for (size_type slot = hash & mask; index[slot]; slot = (slot + 1) & mask)
+            if (entries[index[slot] - 1].first.equals(key, hash))
+                return index[slot] - 1;
+        return npos;
+    }
+
+    size_type locate(std::string_view key) const noexcept
+    {
+        return search(key);
+    }
+
+    size_type locate(object_key const& key) const noexcept
+    {
+        return search(key);
+    }
+
+    void insert_index(size_type pos)
+    {
+        size_type mask = index.size() - 1;
+        size_type slot = entries[pos].first.hash() & mask;
+        while (index[slot])
+            slot = (slot + 1) & mask;
+        index[slot] = static_cast<std::uint32_t>(pos + 1);
+    }
+
+    // keep the index at most half full
+    void rebuild_index()
+    {
+        size_type cap = 2 * index_threshold;
+        while (cap < 2 * entries.size())
+            cap *= 2;
+
+        index.assign(cap, 0);
+        for (size_type i = 0; i < entries.size(); ++i)
+            insert_index(i);
+    }
+
+    void update_index()
+    {
+        if (entries.size() <= index_threshold)
+            return;
+
+        if (index.size() < 2 * entries.size())
+            rebuild_index();
+        else
+            insert_index(entries.size() - 1);
+    }
+
+public:
+    object() = default;
+
+    explicit object(allocator_type alloc)
+        : entries(alloc)
+        , index(alloc)
+    {
+    }
+
+    template <typename It>
+    object(It first, It last, allocator_type alloc = {})
+        : entries(alloc)
+        , index(alloc)
+    {
+        for (; first != last; ++first)
+            try_emplace(first->first, first->second);
+    }
+
+    object(std::initializer_list<value_type> init, allocator_type alloc = {})
+        : object(init.begin(), init.end(), alloc)
+    {
+    }
+
+    allocator_type get_allocator() const noexcept
+    {
+        return entries.get_allocator();
+    }
+
+    size_type size() const noexcept
+    {
+        return entries.size();
+    }
+
+    bool empty() const noexcept
+    {
+        return entries.empty();
+    }
+
+    void reserve(size_type cnt)
+    {
+        entries.reserve(cnt);
+    }
+
+    void clear() noexcept
+    {
+        entries.clear();
+        index.clear();
+    }
+
+    iterator begin() noexcept
+    {
+        return entries.begin();
+    }
+
+    iterator end() noexcept
+    {
+        return entries.end();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return entries.begin();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return entries.end();
+    }
+
+    iterator find(std::string_view key) noexcept
+    {
+        auto pos = locate(key);
+        return pos == npos ? end() : begin() + pos;
+    }
+
+    const_iterator find(std::string_view key) const noexcept
+    {
+        auto pos = locate(key);
+        return pos == npos ? end() : begin() + pos;
+    }
+
+    size_type count(std::string_view key) const noexcept
+    {
+        return locate(key) == npos ? 0 : 1;
+    }
+
+    Node& at(std::string_view key)
+    {
+        auto pos = locate(key);
+        if (pos == npos)
+            throw std::out_of_range("mini_json::object::at : key not found");
+        return entries[pos].second;
+    }
+
+    Node const& at(std::string_view key) const
+    {
+        auto pos = locate(key);
+        if (pos == npos)
+            throw std::out_of_range("mini_json::object::at : key not found");
+        return entries[pos].second;
+    }
+
+    Node& operator[](std::string_view key)
+    {
+        return try_emplace(key).first->second;
+    }
+
+    /**
+     * an existing key is left untouched, like std::unordered_map does
+     */
+    template <typename Key, typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+    {
+        if (auto pos = locate(key); pos != npos)
+            return { begin() + pos, false };
+
+        entries.emplace_back(std::piecewise_construct,
+            std::forward_as_tuple(std::forward<Key>(key)),
+            std::forward_as_tuple(std::forward<Args>(args)...));
+        update_index();
+        return { end() - 1, true };
+    }
+
+    template <typename Key, typename Val>
+    std::pair<iterator, bool> emplace(Key&& key, Val&& val)
+    {
+        return try_emplace(std::forward<Key>(key), std::forward<Val>(val));
+    }
+
+    // positions after pos shift down, so the index is rebuilt
+    iterator erase(const_iterator pos)
+    {
+        auto ret = entries.erase(pos);
+        if (!index.empty())
+            entries.size() > index_threshold ? rebuild_index() : index.clear();
+        return ret;
+    }
+
+    size_type erase(std::string_view key)
+    {
+        auto pos = locate(key);
+        if (pos == npos)
+            return 0;
+
+        erase(begin() + pos);
+        return 1;
+    }
+};
+
+}; // namespace mini_json
@@ -0,0 +1,395 @@
+#pragma once
+#include "exception.hpp"
+#include "lazy.hpp"
+#include "node.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace mini_json {
+
+namespace detail {
+
+// call a callback, one that returns void never stops the search
+template <typename Fn, typename... Args>
+inline bool proceed(Fn& fn, Args&&... args)
+{
+    if constexpr (std::is_void_v<std::invoke_result_t<Fn&, Args...>>) {
+        fn(std::forward<Args>(args)...);
+        return true;
+    } else {
+        return static_cast<bool>(fn(std::forward<Args>(args)...));
+    }
+}
+
+}; // namespace detail
+
+/**
+ * pointer is a json pointer (rfc 6901) compiled once and run many times
+ * against a node, or against raw text through lazy, where only the
+ * values on the way are read and the search stops at the first match
+ * a token "*" matches every member or element, so such a pointer
+ * may select several values, and "-" never matches anything
+ * an invalid pointer throws bad_pointer
+ */
+class pointer {
+
+public:
+    struct token {
+        std::string key;
+        // the key as an array index, npos if it is not one
+        std::size_t index;
+        bool wild;
+    };
+
+    constexpr static std::size_t npos = std::size_t(-1);
+
+private:
+    std::vector<token> tokens;
+    bool wild = false;
+
+    static token compile(std::string_view raw)
+    {
+        token tok { std::string(), npos, raw == "*" };
+        tok.key.reserve(raw.size());
+
+        for (std::size_t i = 0; i < raw.size(); ++i) {
+            if (raw[i] != '~') {
+                tok.key.push_back(raw[i]);
+                continue;
+            }
+
+            if (++i == raw.size() || (raw[i] != '0' && raw[i] != '1'))
+                throw bad_pointer();
+            tok.key.push_back(raw[i] == '0' ? '~' : '/');
+        }
+
+        // digits without a leading zero
+        auto& key = tok.key;
+        if (key.empty() || key.size() > 18 || (key[0] == '0' && key.size() > 1))
+            return tok;
+        if (!std::all_of(key.begin(), key.end(), [](char ch) { return ch >= '0' && ch <= '9'; }))
+            return tok;
+
+        tok.index = std::stoull(key);
+        return tok;
+    }
+
+    template <typename Node, typename Fn>
+    static bool walk(Node& cur, token const* it, token const* end, Fn& fn)
+    {
+        if (it == end)
+            return detail::proceed(fn, cur);
+
+        if (auto* obj = std::get_if<node::obj_t>(&cur.data); obj) {
+            if (!it->wild) {
+                auto got = obj->find(it->key);
+                return got == obj->end() || walk(got->second, it + 1, end, fn);
+            }
+
+            for (auto& ent : *obj)
+                if (!walk(ent.second, it + 1, end, fn))
+                    return false;
+            return true;
+        }
+
+        if (auto* arr = std::get_if<node::arr_t>(&cur.data); arr) {
+            if (!it->wild)
+                return it->index >= arr->size() || walk((*arr)[it->index], it + 1, end, fn);
+
+            for (auto& elem : *arr)
+                if (!walk(elem, it + 1, end, fn))
+                    return false;
+            return true;
+        }
+
+        return true;
+    }
+
+    template <typename Fn>
+    static bool scan(lazy cur, token const* it, token const* end, Fn& fn)
+    {
+        if (it == end)
+            return detail::proceed(fn, cur);
+
+        char type = cur.kind();
+        if (type == '{') {
+            for (auto el = cur.begin(), ed = cur.end(); el != ed; ++el) {
+                if (it->wild) {
+                    if (!scan(*el, it + 1, end, fn))
+                        return false;
+                } else if (el.key_is(it->key)) {
+                    return scan(*el, it + 1, end, fn);
+                }
+            }
+            return true;
+        }
+
+        if (type == '[' && (it->wild || it->index != npos)) {
+            std::size_t idx = 0;
+            for (auto el = cur.begin(), ed = cur.end(); el != ed; ++el, ++idx) {
+                if (it->wild) {
+                    if (!scan(*el, it + 1, end, fn))
+                        return false;
+                } else if (idx == it->index) {
+                    return scan(*el, it + 1, end, fn);
+                }
+            }
+        }
+
+        return true;
+    }
+
+public:
+    // the empty pointer, which selects the whole document
+    pointer() = default;
+
+    explicit pointer(std::string_view path)
+    {
+        if (path.empty())
+            return;
+        if (path[0] != '/')
+            throw bad_pointer();
+
+        for (std::size_t first = 1;;) {
+            std::size_t last = std::min(path.find('/', first), path.size());
+            tokens.push_back(compile(path.substr(first, last - first)));
+            wild |= tokens.back().wild;
+
+            if (last == path.size())
+                break;
+            first = last + 1;
+        }
+    }
+
+    std::vector<token> const& path() const noexcept
+    {
+        return tokens;
+    }
+
+    // whether the pointer has a "*" token and may select several values
+    bool wildcard() const noexcept
+    {
+        return wild;
+    }
+
+    /**
+     * call fn on every value selected, in document order,
+     * fn may return false to stop the search
+     */
+    template <typename Fn>
+    void select(node& root, Fn&& fn) const
+    {
+        walk(root, tokens.data(), tokens.data() + tokens.size(), fn);
+    }
+
+    template <typename Fn>
+    void select(node const& root, Fn&& fn) const
+    {
+        walk(root, tokens.data(), tokens.data() + tokens.size(), fn);
+    }
+
+    template <typename Fn>
+    void select(lazy root, Fn&& fn) const
+    {
+        scan(root, tokens.data(), tokens.data() + tokens.size(), fn);
+    }
+
+    // the first value selected, or nullptr
+    node* find(node& root) const
+    {
+        node* ret = nullptr;
+        select(root, [&ret](node& got) {
+            ret = &got;
+            return false;
+        });
+        return ret;
+    }
+
+    node const* find(node const& root) const
+    {
+        node const* ret = nullptr;
+        select(root, [&ret](node const& got) {
+            ret = &got;
+            return false;
+        });
+        return ret;
+    }
+
+    std::optional<lazy> find(lazy root) const
+    {
+        std::optional<lazy> ret;
+        select(root, [&ret](lazy got) {
+            ret = got;
+            return false;
+        });
+        return ret;
+    }
+};
+
+/**
+ * query runs several pointers together, on raw text in a single pass
+ * a container is left as soon as every pointer running through it
+ * has found its value, and the whole document as soon as every pointer
+ * has, so a query without "*" reads no further than its last target
+ */
+class query {
+
+private:
+    std::vector<pointer> paths;
+
+    struct state {
+        // indices of the pointers that match up to the current depth
+        std::vector<std::size_t> active;
+        // pointers without "*" are settled once their value was found,
+        // or once it is known not to exist, like for a repeated key
+        std::vector<char> settled;
+        std::size_t left;
+    };
+
+    // return false once every pointer is settled
+    bool settle(state& st, std::size_t which) const
+    {
+        if (paths[which].wildcard() || st.settled[which])
+            return true;
+        st.settled[which] = true;
+        return --st.left != 0;
+    }
+
+    bool done(state const& st, std::size_t first, std::size_t last) const
+    {
+        for (std::size_t i = first; i < last; ++i)
+            if (!st.settled[st.active[i]])
+                return false;
+        return true;
+    }
+
+    // whether the pointer has its value in this member or element
+    static bool match(pointer::token const& tok, lazy::iterator const& el, std::size_t idx, bool member)
+    {
+        if (tok.wild)
+            return true;
+        return member ? el.key_is(tok.key) : idx == tok.index;
+    }
+
+    // active[first, last) match cur up to depth, return false to stop
+    template <typename Fn>
+    bool walk(lazy cur, std::size_t depth, state& st, std::size_t first, std::size_t last, Fn& fn) const
+    {
+        // pointers ending here go first and leave the range
+        for (std::size_t i = first; i < last;) {
+            std::size_t which = st.active[i];
+            if (paths[which].path().size() != depth) {
+                ++i;
+                continue;
+            }
+
+            if (!detail::proceed(fn, which, cur) || !settle(st, which))
+                return false;
+            std::swap(st.active[i], st.active[--last]);
+        }
+
+        char type = first == last ? '\0' : cur.kind();
+        if (type != '{' && type != '[')
+            return true;
+
+        bool member = type == '{';
+        std::size_t idx = 0;
+        for (auto el = cur.begin(), ed = cur.end(); el != ed; ++el, ++idx) {
+            std::size_t next = st.active.size();
+            for (std::size_t i = first; i < last; ++i) {
+                std::size_t which = st.active[i];
+                if (!st.settled[which] && match(paths[which].path()[depth], el, idx, member))
+                    st.active.push_back(which);
+            }
+
+            if (next != st.active.size()) {
+                // whatever was not found below this value does not exist
+                bool go = walk(*el, depth + 1, st, next, st.active.size(), fn);
+                for (std::size_t i = next; go && i < st.active.size(); ++i)
+                    go = settle(st, st.active[i]);
+
+                st.active.resize(next);
+                if (!go)
+                    return false;
+            }
+
+            // the rest of the container is not even skipped over
+            if (done(st, first, last))
+                break;
+        }
+
+        return true;
+    }
+
+public:
+    query() = default;
+
+    query(std::initializer_list<std::string_view> init)
+    {
+        for (auto path : init)
+            add(path);
+    }
+
+    // compile a pointer, return its index for the callback
+    std::size_t add(std::string_view path)
+    {
+        paths.emplace_back(path);
+        return paths.size() - 1;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return paths.size();
+    }
+
+    pointer const& operator[](std::size_t idx) const noexcept
+    {
+        return paths[idx];
+    }
+
+    /**
+     * call fn(index, value) on every value selected by every pointer,
+     * fn may return false to stop the search
+     * on a node, the pointers run one after another
+     */
+    template <typename Fn>
+    void run(node& root, Fn&& fn) const
+    {
+        bool go = true;
+        for (std::size_t i = 0; go && i < paths.size(); ++i)
+            paths[i].select(root, [&](node& got) { return go = detail::proceed(fn, i, got); });
+    }
+
+    template <typename Fn>
+    void run(node const& root, Fn&& fn) const
+    {
+        bool go = true;
+        for (std::size_t i = 0; go && i < paths.size(); ++i)
+            paths[i].select(root, [&](node const& got) { return go = detail::proceed(fn, i, got); });
+    }
+
+    template <typename Fn>
+    void run(lazy root, Fn&& fn) const
+    {
+        state st { std::vector<std::size_t>(paths.size()), std::vector<char>(paths.size()), paths.size() };
+        for (std::size_t i = 0; i < paths.size(); ++i) {
+            st.active[i] = i;
+            // a query with "*" is never done
+            if (paths[i].wildcard())
+                st.left = std::size_t(-1);
+        }
+
+        if (!paths.empty())
+            walk(root, 0, st, 0, paths.size(), fn);
+    }
+};
+
+}; // namespace mini_json
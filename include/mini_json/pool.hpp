@@ -0,0 +1,284 @@
+#pragma once
+#include "json.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mini_json::detail {
+
+/**
+ * parse_pool parses independent documents on persistent worker threads
+ * and hands the nodes over in input order
+ * documents come in batches from a splitter run on the calling thread,
+ * the next batch is split while the workers parse the current one and
+ * is parsed while the current one is handed over, so at most two
+ * batches of nodes are held at once
+ * the calling thread takes part in parsing, so a pool of n workers
+ * starts n - 1 threads, which sleep between batches
+ * every worker keeps one json object, so only its parsing buffers are
+ * reused, the nodes come from the default resource rather than an arena
+ * of the worker, as they are handed over and must outlive its next parse
+ */
+class parse_pool {
+
+public:
+    using error_code = json::error_code;
+
+    constexpr static std::size_t batch_size = 16384;
+    // documents a worker takes at once
+    constexpr static std::size_t grain = 64;
+
+    struct document {
+        std::string_view text;
+        // where the document is, reported when it is invalid
+        std::size_t pos;
+    };
+
+private:
+    struct batch {
+        std::vector<document> docs;
+        std::vector<node> nodes;
+        std::vector<error_code> codes;
+        std::atomic<std::size_t> next { 0 };
+        // index of the first invalid document, or the size of docs
+        std::atomic<std::size_t> failed { 0 };
+    };
+
+    std::vector<std::unique_ptr<json>> workers;
+    std::vector<std::thread> threads;
+    batch batches[2];
+    error_code perr = error_code::non;
+    std::size_t ppos = 0;
+
+    // hand-over between the calling thread and the workers
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    batch* current = nullptr;
+    std::size_t generation = 0;
+    std::size_t busy = 0;
+    bool stop = false;
+
+    // take blocks of documents until none is left or one before them failed
+    void work(json& parser, batch& got)
+    {
+        while (true) {
+            std::size_t first = got.next.fetch_add(grain);
+            if (first >= got.failed.load())
+                return;
+
+            std::size_t last = std::min(first + grain, got.docs.size());
+            for (std::size_t i = first; i < last; ++i) {
+                parser.reset_view(got.docs[i].text);
+                if (node* ret = parser.parse(); ret) {
+                    got.nodes[i] = std::move(*ret);
+                    continue;
+                }
+
+                got.codes[i] = parser.errp();
+                std::size_t seen = got.failed.load();
+                while (i < seen && !got.failed.compare_exchange_weak(seen, i))
+                    ;
+                return;
+            }
+        }
+    }
+
+    // the loop of a worker thread, which sleeps until a batch is started
+    void serve(json& parser)
+    {
+        std::unique_lock<std::mutex> hold(lock);
+        std::size_t seen = 0;
+
+        while (true) {
+            wake.wait(hold, [&] { return stop || generation != seen; });
+            if (stop)
+                return;
+
+            // a batch finished before this worker woke up is skipped
+            seen = generation;
+            batch* got = current;
+            if (!got)
+                continue;
+
+            ++busy;
+            hold.unlock();
+            work(parser, *got);
+            hold.lock();
+            if (--busy == 0)
+                idle.notify_all();
+        }
+    }
+
+    void start(batch& got)
+    {
+        got.nodes.clear();
+        got.nodes.resize(got.docs.size());
+        got.codes.assign(got.docs.size(), error_code::non);
+        got.next.store(0);
+        got.failed.store(got.docs.size());
+
+        // small batches are not worth waking other threads for
+        if (threads.empty() || got.docs.size() <= grain)
+            return;
+
+        {
+            std::lock_guard<std::mutex> hold(lock);
+            current = &got;
+            ++generation;
+        }
+        wake.notify_all();
+    }
+
+    // help parsing the batch, then wait for the workers still on it
+    void finish(batch& got)
+    {
+        work(*workers[0], got);
+
+        std::unique_lock<std::mutex> hold(lock);
+        idle.wait(hold, [this] { return busy == 0; });
+        if (current == &got)
+            current = nullptr;
+    }
+
+    // when run is left, even by an exception, no batch is left to the workers
+    struct drain {
+        parse_pool& pool;
+
+        ~drain()
+        {
+            for (auto& got : pool.batches) {
+                got.failed.store(0);
+                pool.finish(got);
+            }
+        }
+    };
+
+    // hand the nodes of a finished batch over, stop at the first invalid one
+    template <typename Callback>
+    bool hand_over(batch& got, Callback& callback)
+    {
+        std::size_t failed = got.failed.load();
+        for (std::size_t i = 0; i < failed; ++i)
+            callback(got.nodes[i]);
+
+        if (failed == got.docs.size())
+            return true;
+
+        perr = got.codes[failed];
+        ppos = got.docs[failed].pos;
+        return false;
+    }
+
+public:
+    explicit parse_pool(std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            workers.push_back(std::make_unique<json>(std::string()));
+
+        for (std::size_t i = 1; i < count; ++i)
+            threads.emplace_back([this, i] { serve(*workers[i]); });
+    }
+
+    parse_pool(parse_pool const&) = delete;
+    parse_pool& operator=(parse_pool const&) = delete;
+
+    ~parse_pool()
+    {
+        {
+            std::lock_guard<std::mutex> hold(lock);
+            stop = true;
+        }
+        wake.notify_all();
+
+        for (auto& th : threads)
+            th.join();
+    }
+
+    /**
+     * split(docs, last) appends the next documents to docs, at most
+     * batch_size of them, and sets last at the end of the input
+     * it returns false if the input itself is invalid, after calling report
+     * callback(node&) is called on every document in input order, and
+     * parsing stops at the first invalid one, after all before it
+     */
+    template <typename Split, typename Callback>
+    bool run(Split&& split, Callback&& callback)
+    {
+        perr = error_code::non;
+        ppos = 0;
+
+        drain guard { *this };
+        batch* cur = &batches[0];
+        batch* nxt = &batches[1];
+        bool last = false;
+
+        cur->docs.clear();
+        if (!split(cur->docs, last))
+            return false;
+        start(*cur);
+
+        while (true) {
+            bool split_ok = true;
+            bool more = !last;
+            if (more) {
+                nxt->docs.clear();
+                split_ok = more = split(nxt->docs, last);
+            }
+
+            finish(*cur);
+            if (more)
+                start(*nxt);
+
+            // the next batch, if started, is then stopped by guard
+            if (!hand_over(*cur, callback))
+                return false;
+
+            if (!split_ok || !more)
+                return split_ok;
+            std::swap(cur, nxt);
+        }
+    }
+
+    /**
+     * record an error of the input found while splitting, or the result
+     * of input parsed without splitting, it is true only for error_code::non
+     */
+    bool report(error_code code, std::size_t pos) noexcept
+    {
+        perr = code;
+        ppos = pos;
+        return code == error_code::non;
+    }
+
+    error_code errp() const noexcept
+    {
+        return perr;
+    }
+
+    std::size_t errpos() const noexcept
+    {
+        return ppos;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return workers.size();
+    }
+
+    // the worker of the calling thread, for input not worth splitting
+    json& front() noexcept
+    {
+        return *workers[0];
+    }
+};
+
+}; // namespace mini_json::detail
@@ -0,0 +1,379 @@
+#pragma once
+#include "json.hpp"
+#include "number.hpp"
+#include "scan.hpp"
+#include "string.hpp"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace mini_json {
+
+/**
+ * push_parser parses input that arrives in chunks of any size
+ * and sends the events of json::parse(handler) as soon as they are complete
+ * a string, escape, number or literal cut by the end of a chunk
+ * is kept until the next feed, everything else is never copied
+ * the input may hold any number of top-level values separated by whitespace,
+ * so 1 2 and {} {} are two values while 1true and {}{} fail with root_singular
+ * strings passed to the handler are only valid during the call
+ */
+template <typename Handler>
+class push_parser {
+
+public:
+    using error_code = json::error_code;
+
+private:
+    enum class state {
+        value, // a value, or whitespace between top-level values
+        after, // the whitespace that must follow a top-level value
+        first_value, // a value or ']' right after '['
+        first_key, // a key or '}' right after '{'
+        key, // a key after ','
+        colon, // the ':' after a key
+        next, // a ',' or the end of the container
+        string,
+        number,
+        literal,
+    };
+
+    struct frame {
+        char type;
+        std::size_t count;
+    };
+
+    Handler& handler;
+    state st = state::value;
+    std::vector<frame> stack;
+    // the part of a string, number or literal seen so far
+    std::string token;
+    std::string decoded;
+    bool in_key = false;
+    bool escaped = false;
+    std::size_t values = 0;
+    error_code err = error_code::non;
+
+public:
+    explicit push_parser(Handler& handler)
+        : handler(handler)
+    {
+    }
+
+    /**
+     * parse the next chunk, fails once an error was found
+     */
+    bool feed(std::string_view chunk)
+    {
+        char const* it = chunk.data();
+        char const* end = it + chunk.size();
+
+        while (err == error_code::non && it != end)
+            it = step(it, end);
+
+        return err == error_code::non;
+    }
+
+    /**
+     * tell that the input is over, which completes a trailing number
+     * fails if the input stops within a value or has no value at all
+     */
+    bool finish()
+    {
+        if (err != error_code::non)
+            return false;
+
+        if (st == state::number && !emit_number(token.data(), token.data() + token.size()))
+            return false;
+
+        if (st == state::string || st == state::literal)
+            return fail(error_code::invalid_value);
+
+        if ((st != state::value && st != state::after) || !stack.empty() || values == 0)
+            return fail(error_code::expect_value);
+
+        return true;
+    }
+
+    // start over with a new input, keeping the buffers
+    void reset() noexcept
+    {
+        st = state::value;
+        stack.clear();
+        token.clear();
+        escaped = false;
+        values = 0;
+        err = error_code::non;
+    }
+
+    error_code errp() const noexcept
+    {
+        return err;
+    }
+
+    // number of containers opened and not closed yet
+    std::size_t depth() const noexcept
+    {
+        return stack.size();
+    }
+
+private:
+    bool fail(error_code code) noexcept
+    {
+        err = code;
+        return false;
+    }
+
+    bool check(bool go) noexcept
+    {
+        return go || fail(error_code::aborted);
+    }
+
+    // a value is complete, go on with its container
+    bool done(bool go) noexcept
+    {
+        if (!check(go))
+            return false;
+
+        if (stack.empty()) {
+            ++values;
+            st = state::after;
+        } else {
+            ++stack.back().count;
+            st = state::next;
+        }
+        return true;
+    }
+
+    char const* step(char const* it, char const* end)
+    {
+        switch (st) {
+        case state::string:
+            return lex_string(it, end);
+        case state::number:
+            return lex_number(it, end);
+        case state::literal:
+            return lex_literal(it, end);
+        case state::after:
+            if (!detail::is_ws(*it)) {
+                fail(error_code::root_singular);
+                return it;
+            }
+            st = state::value;
+            break;
+        default:
+            break;
+        }
+
+        it = detail::skip_ws(it, end);
+        if (it == end)
+            return it;
+
+        switch (st) {
+        case state::colon:
+            if (*it != ':') {
+                fail(error_code::miss_separator);
+                return it;
+            }
+            st = state::value;
+            return it + 1;
+
+        case state::next:
+            if (*it == ',') {
+                st = stack.back().type == '[' ? state::value : state::key;
+                return it + 1;
+            }
+            if (*it == (stack.back().type == '[' ? ']' : '}'))
+                return close(it);
+            fail(error_code::miss_separator);
+            return it;
+
+        case state::first_key:
+            if (*it == '}')
+                return close(it);
+            [[fallthrough]];
+        case state::key:
+            if (*it != '\"') {
+                fail(error_code::invalid_key);
+                return it;
+            }
+            in_key = true;
+            return string_start(it + 1, end);
+
+        case state::first_value:
+            if (*it == ']')
+                return close(it);
+            [[fallthrough]];
+        default:
+            return value(it, end);
+        }
+    }
+
+    char const* value(char const* it, char const* end)
+    {
+        switch (*it) {
+        case '\"':
+            in_key = false;
+            return string_start(it + 1, end);
+
+        case '[':
+            stack.push_back({ '[', 0 });
+            st = state::first_value;
+            check(handler.start_array());
+            return it + 1;
+
+        case '{':
+            stack.push_back({ '{', 0 });
+            st = state::first_key;
+            check(handler.start_object());
+            return it + 1;
+
+        case 'n':
+        case 't':
+        case 'f':
+            token.assign(1, *it);
+            st = state::literal;
+            return lex_literal(it + 1, end);
+
+        default:
+            if (*it != '-' && !detail::is_digit(*it)) {
+                fail(error_code::invalid_value);
+                return it;
+            }
+            token.clear();
+            st = state::number;
+            return lex_number(it, end);
+        }
+    }
+
+    char const* close(char const* it)
+    {
+        frame top = stack.back();
+        stack.pop_back();
+        done(top.type == '[' ? handler.end_array(top.count) : handler.end_object(top.count));
+        return it + 1;
+    }
+
+    void emit_string(std::string_view str)
+    {
+        if (!in_key)
+            done(handler.string(str));
+        else if (check(handler.key(str)))
+            st = state::colon;
+    }
+
+    // a string held entirely by the chunk goes to the handler without a copy
+    char const* string_start(char const* it, char const* end)
+    {
+        char const* run = detail::next_quote(it, end);
+        if (run != end && *run == '\"') {
+            emit_string(std::string_view(it, run - it));
+            return run + 1;
+        }
+
+        token.clear();
+        escaped = false;
+        st = state::string;
+        return lex_string(it, end);
+    }
+
+    // collect the raw string up to the closing quote, then decode it at once
+    char const* lex_string(char const* it, char const* end)
+    {
+        while (it != end) {
+            if (escaped) {
+                token.push_back(*it++);
+                escaped = false;
+                continue;
+            }
+
+            char const* run = detail::next_quote(it, end);
+            token.append(it, run);
+            it = run;
+            if (it == end)
+                break;
+
+            if (*it == '\\') {
+                token.push_back('\\');
+                escaped = true;
+                ++it;
+                continue;
+            }
+
+            token.push_back('\"');
+            char const* first = token.data();
+            switch (detail::unescape(first, first + token.size(), decoded)) {
+            case detail::string_error::non:
+                emit_string(decoded);
+                break;
+            case detail::string_error::unterminated:
+                fail(error_code::invalid_value);
+                break;
+            default:
+                fail(error_code::invalid_escape);
+                break;
+            }
+            return it + 1;
+        }
+
+        return it;
+    }
+
+    static bool is_number_char(char ch) noexcept
+    {
+        return detail::is_digit(ch) || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+    }
+
+    // a number only ends at the first byte that cannot belong to it
+    char const* lex_number(char const* it, char const* end)
+    {
+        char const* last = it;
+        while (last != end && is_number_char(*last))
+            ++last;
+
+        if (last == end) {
+            token.append(it, last);
+        } else if (token.empty()) {
+            emit_number(it, last);
+        } else {
+            token.append(it, last);
+            emit_number(token.data(), token.data() + token.size());
+        }
+        return last;
+    }
+
+    bool emit_number(char const* first, char const* last)
+    {
+        detail::number_literal num;
+        if (!detail::scan_number(first, last, num) || num.end != last)
+            return fail(error_code::invalid_value);
+
+        bool go = true;
+        if (!detail::emit_number(num, handler, go))
+            return fail(error_code::invalid_value);
+        return done(go);
+    }
+
+    char const* lex_literal(char const* it, char const* end)
+    {
+        std::size_t want = token[0] == 'f' ? 5 : 4;
+        while (it != end && token.size() < want)
+            token.push_back(*it++);
+
+        if (token.size() < want)
+            return it;
+
+        if (token == "null")
+            done(handler.null());
+        else if (token == "true")
+            done(handler.boolean(true));
+        else if (token == "false")
+            done(handler.boolean(false));
+        else
+            fail(error_code::invalid_value);
+        return it;
+    }
+};
+
+}; // namespace mini_json
@@ -0,0 +1,319 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#if !defined(MINI_JSON_NO_SIMD)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MINI_JSON_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MINI_JSON_SSE2
+#endif
+#endif
+
+namespace mini_json::detail {
+
+/**
+ * scan provides the block scanning primitives used by the parser
+ * every function works on [it, end) and never reads past end
+ * blocks are 32 bytes with AVX2, 16 bytes with SSE2
+ * and one byte at a time for the scalar fallback
+ */
+
+inline bool is_ws(char ch) noexcept
+{
+    return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r';
+}
+
+inline bool is_structural(char ch) noexcept
+{
+    switch (ch) {
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+    case '\"':
+        return true;
+    default:
+        return false;
+    }
+}
+
+// count trailing zeros of a non-zero mask
+inline unsigned ctz(std::uint32_t mask) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#else
+    unsigned n = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+#if defined(MINI_JSON_AVX2)
+
+constexpr std::size_t block_size = 32;
+
+// bit i of the mask is set if byte i of the block is whitespace
+inline std::uint32_t ws_mask(char const* it) noexcept
+{
+    __m256i blk = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(it));
+    __m256i ws = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(blk, _mm256_set1_epi8(' ')),
+            _mm256_cmpeq_epi8(blk, _mm256_set1_epi8('\n'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(blk, _mm256_set1_epi8('\t')),
+            _mm256_cmpeq_epi8(blk, _mm256_set1_epi8('\r'))));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(ws));
+}
+
+// bit i of the mask is set if byte i of the block is one of {}[]:,"
+inline std::uint32_t structural_mask(char const* it) noexcept
+{
+    __m256i blk = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(it));
+    // '[' and '{', ']' and '}' only differ in bit 0x20
+    __m256i low = _mm256_or_si256(blk, _mm256_set1_epi8(0x20));
+    __m256i st = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(low, _mm256_set1_epi8('{')),
+            _mm256_cmpeq_epi8(low, _mm256_set1_epi8('}'))),
+        _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(blk, _mm256_set1_epi8(':')),
+                _mm256_cmpeq_epi8(blk, _mm256_set1_epi8(','))),
+            _mm256_cmpeq_epi8(blk, _mm256_set1_epi8('\"'))));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(st));
+}
+
+// bit i of the mask is set if byte i of the block is a quote or backslash
+inline std::uint32_t quote_mask(char const* it) noexcept
+{
+    __m256i blk = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(it));
+    __m256i qt = _mm256_or_si256(_mm256_cmpeq_epi8(blk, _mm256_set1_epi8('\"')),
+        _mm256_cmpeq_epi8(blk, _mm256_set1_epi8('\\')));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(qt));
+}
+
+// bit i of the mask is set if byte i of the block must be escaped
+// that is a quote, a backslash or a control character below 0x20
+inline std::uint32_t escape_mask(char const* it) noexcept
+{
+    __m256i blk = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(it));
+    __m256i ctl = _mm256_cmpeq_epi8(_mm256_min_epu8(blk, _mm256_set1_epi8(0x1F)), blk);
+    __m256i qt = _mm256_or_si256(_mm256_cmpeq_epi8(blk, _mm256_set1_epi8('\"')),
+        _mm256_cmpeq_epi8(blk, _mm256_set1_epi8('\\')));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(ctl, qt)));
+}
+
+constexpr std::uint32_t full_mask = 0xFFFFFFFFu;
+
+#elif defined(MINI_JSON_SSE2)
+
+constexpr std::size_t block_size = 16;
+
+inline std::uint32_t ws_mask(char const* it) noexcept
+{
+    __m128i blk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(it));
+    __m128i ws = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(blk, _mm_set1_epi8(' ')),
+            _mm_cmpeq_epi8(blk, _mm_set1_epi8('\n'))),
+        _mm_or_si128(_mm_cmpeq_epi8(blk, _mm_set1_epi8('\t')),
+            _mm_cmpeq_epi8(blk, _mm_set1_epi8('\r'))));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(ws));
+}
+
+inline std::uint32_t structural_mask(char const* it) noexcept
+{
+    __m128i blk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(it));
+    __m128i low = _mm_or_si128(blk, _mm_set1_epi8(0x20));
+    __m128i st = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(low, _mm_set1_epi8('{')),
+            _mm_cmpeq_epi8(low, _mm_set1_epi8('}'))),
+        _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(blk, _mm_set1_epi8(':')),
+                _mm_cmpeq_epi8(blk, _mm_set1_epi8(','))),
+            _mm_cmpeq_epi8(blk, _mm_set1_epi8('\"'))));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(st));
+}
+
+inline std::uint32_t quote_mask(char const* it) noexcept
+{
+    __m128i blk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(it));
+    __m128i qt = _mm_or_si128(_mm_cmpeq_epi8(blk, _mm_set1_epi8('\"')),
+        _mm_cmpeq_epi8(blk, _mm_set1_epi8('\\')));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(qt));
+}
+
+inline std::uint32_t escape_mask(char const* it) noexcept
+{
+    __m128i blk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(it));
+    __m128i ctl = _mm_cmpeq_epi8(_mm_min_epu8(blk, _mm_set1_epi8(0x1F)), blk);
+    __m128i qt = _mm_or_si128(_mm_cmpeq_epi8(blk, _mm_set1_epi8('\"')),
+        _mm_cmpeq_epi8(blk, _mm_set1_epi8('\\')));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(ctl, qt)));
+}
+
+constexpr std::uint32_t full_mask = 0xFFFFu;
+
+#else
+
+constexpr std::size_t block_size = 1;
+
+#endif
+
+/**
+ * skip_ws returns the first non-whitespace position in [it, end)
+ * compact documents rarely have whitespace, so check one byte first
+ * and only switch to blocks once a run of indentation is found
+ */
+inline char const* skip_ws(char const* it, char const* end) noexcept
+{
+    if (it == end || !is_ws(*it))
+        return it;
+
+#if defined(MINI_JSON_AVX2) || defined(MINI_JSON_SSE2)
+    while (std::size_t(end - it) >= block_size) {
+        std::uint32_t mask = ~ws_mask(it) & full_mask;
+        if (mask)
+            return it + ctz(mask);
+        it += block_size;
+    }
+#endif
+
+    while (it != end && is_ws(*it))
+        ++it;
+    return it;
+}
+
+/**
+ * next_structural returns the first position in [it, end) holding
+ * one of {}[]:," or end if there is none
+ */
+inline char const* next_structural(char const* it, char const* end) noexcept
+{
+#if defined(MINI_JSON_AVX2) || defined(MINI_JSON_SSE2)
+    while (std::size_t(end - it) >= block_size) {
+        std::uint32_t mask = structural_mask(it);
+        if (mask)
+            return it + ctz(mask);
+        it += block_size;
+    }
+#endif
+
+    while (it != end && !is_structural(*it))
+        ++it;
+    return it;
+}
+
+/**
+ * next_quote returns the first quote or backslash in [it, end)
+ * so that the plain run before it can be copied at once
+ */
+inline char const* next_quote(char const* it, char const* end) noexcept
+{
+#if defined(MINI_JSON_AVX2) || defined(MINI_JSON_SSE2)
+    while (std::size_t(end - it) >= block_size) {
+        std::uint32_t mask = quote_mask(it);
+        if (mask)
+            return it + ctz(mask);
+        it += block_size;
+    }
+#endif
+
+    while (it != end && *it != '\"' && *it != '\\')
+        ++it;
+    return it;
+}
+
+inline bool need_escape(char ch) noexcept
+{
+    return static_cast<unsigned char>(ch) < 0x20 || ch == '\"' || ch == '\\';
+}
+
+/**
+ * next_escape returns the first byte in [it, end) that json
+ * requires to be escaped, so the clean run before it is copied at once
+ */
+inline char const* next_escape(char const* it, char const* end) noexcept
+{
+#if defined(MINI_JSON_AVX2) || defined(MINI_JSON_SSE2)
+    while (std::size_t(end - it) >= block_size) {
+        std::uint32_t mask = escape_mask(it);
+        if (mask)
+            return it + ctz(mask);
+        it += block_size;
+    }
+#endif
+
+    while (it != end && !need_escape(*it))
+        ++it;
+    return it;
+}
+
+/**
+ * skip_string returns the end of a string whose opening quote
+ * is right before it, or nullptr if the string is not closed
+ */
+inline char const* skip_string(char const* it, char const* end) noexcept
+{
+    while (true) {
+        it = next_quote(it, end);
+        if (it == end)
+            return nullptr;
+        if (*it == '\"')
+            return it + 1;
+        if (end - it < 2)
+            return nullptr;
+        it += 2;
+    }
+}
+
+/**
+ * skip_value returns the end of the value starting at it, or nullptr
+ * only quotes, escapes and brackets are looked at, so the value
+ * itself is not checked, and a scalar ends at whitespace or {}[]:,"
+ */
+inline char const* skip_value(char const* it, char const* end) noexcept
+{
+    if (it == end)
+        return nullptr;
+
+    if (*it == '\"')
+        return skip_string(it + 1, end);
+
+    if (*it != '[' && *it != '{') {
+        char const* st = it;
+        while (it != end && !is_ws(*it) && !is_structural(*it))
+            ++it;
+        return it == st ? nullptr : it;
+    }
+
+    std::size_t depth = 0;
+    while (true) {
+        it = next_structural(it, end);
+        if (it == end)
+            return nullptr;
+
+        switch (*it++) {
+        case '\"':
+            if (!(it = skip_string(it, end)))
+                return nullptr;
+            break;
+        case '[':
+        case '{':
+            ++depth;
+            break;
+        case ']':
+        case '}':
+            if (--depth == 0)
+                return it;
+            break;
+        }
+    }
+}
+
+}; // namespace mini_json::detail
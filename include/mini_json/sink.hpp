@@ -0,0 +1,239 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define MINI_JSON_FD_SINK
+#endif
+
+namespace mini_json {
+
+/**
+ * a sink receives the output of json::write a block at a time
+ * through bool write(char const* data, std::size_t size),
+ * returning false stops the output and fails the write
+ */
+
+// appends to a string, which is what json::str uses
+class string_sink {
+
+private:
+    std::string& out;
+
+public:
+    explicit string_sink(std::string& out)
+        : out(out)
+    {
+    }
+
+    bool write(char const* data, std::size_t size)
+    {
+        out.append(data, size);
+        return true;
+    }
+};
+
+class ostream_sink {
+
+private:
+    std::ostream& os;
+
+public:
+    explicit ostream_sink(std::ostream& os)
+        : os(os)
+    {
+    }
+
+    bool write(char const* data, std::size_t size)
+    {
+        return bool(os.write(data, static_cast<std::streamsize>(size)));
+    }
+};
+
+#if defined(MINI_JSON_FD_SINK)
+// writes to a file descriptor, which stays owned by the caller
+class fd_sink {
+
+private:
+    int fd;
+
+public:
+    explicit fd_sink(int fd)
+        : fd(fd)
+    {
+    }
+
+    bool write(char const* data, std::size_t size)
+    {
+        while (size) {
+            auto got = ::write(fd, data, size);
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got <= 0)
+                return false;
+
+            data += got;
+            size -= static_cast<std::size_t>(got);
+        }
+        return true;
+    }
+};
+#endif
+
+// passes every block to fn(std::string_view), which may return false to stop
+template <typename Fn>
+class callback_sink {
+
+private:
+    Fn fn;
+
+public:
+    explicit callback_sink(Fn fn)
+        : fn(std::move(fn))
+    {
+    }
+
+    bool write(char const* data, std::size_t size)
+    {
+        if constexpr (std::is_void_v<std::invoke_result_t<Fn&, std::string_view>>) {
+            fn(std::string_view(data, size));
+            return true;
+        } else {
+            return static_cast<bool>(fn(std::string_view(data, size)));
+        }
+    }
+};
+
+/**
+ * buffer_sink fills a buffer of the caller, the output that does not
+ * fit is dropped but still counted, so size() tells how large
+ * the buffer has to be, the output is not null terminated
+ */
+class buffer_sink {
+
+private:
+    char* data;
+    std::size_t capacity;
+    std::size_t bytes = 0;
+
+public:
+    buffer_sink(char* data, std::size_t capacity)
+        : data(data)
+        , capacity(capacity)
+    {
+    }
+
+    bool write(char const* src, std::size_t size)
+    {
+        if (bytes < capacity)
+            std::memcpy(data + bytes, src, std::min(size, capacity - bytes));
+        bytes += size;
+        return true;
+    }
+
+    // bytes of the whole output
+    std::size_t size() const noexcept
+    {
+        return bytes;
+    }
+
+    bool truncated() const noexcept
+    {
+        return bytes > capacity;
+    }
+};
+
+namespace detail {
+
+/**
+ * writer gathers small pieces of output in a fixed buffer
+ * and passes them to the sink once it is full, so the memory
+ * of writing does not depend on the size of the document
+ */
+template <typename Sink>
+class writer {
+
+public:
+    constexpr static std::size_t buffer_size = 16384;
+
+private:
+    Sink& sink;
+    std::size_t len = 0;
+    bool ok = true;
+    char buf[buffer_size];
+
+public:
+    explicit writer(Sink& sink)
+        : sink(sink)
+    {
+    }
+
+    writer(writer const&) = delete;
+    writer& operator=(writer const&) = delete;
+
+    void put(char ch)
+    {
+        if (len == buffer_size)
+            flush();
+        buf[len++] = ch;
+    }
+
+    // large pieces skip the buffer
+    void append(char const* data, std::size_t size)
+    {
+        if (size > buffer_size - len) {
+            flush();
+            if (size >= buffer_size) {
+                ok = ok && sink.write(data, size);
+                return;
+            }
+        }
+
+        std::memcpy(buf + len, data, size);
+        len += size;
+    }
+
+    void append(std::string_view str)
+    {
+        append(str.data(), str.size());
+    }
+
+    // room for at least size bytes, which are then kept by commit
+    char* reserve(std::size_t size)
+    {
+        if (size > buffer_size - len)
+            flush();
+        return buf + len;
+    }
+
+    void commit(char* last) noexcept
+    {
+        len = static_cast<std::size_t>(last - buf);
+    }
+
+    // false once the sink has failed
+    bool flush()
+    {
+        if (len && ok)
+            ok = sink.write(buf, len);
+        len = 0;
+        return ok;
+    }
+
+    bool good() const noexcept
+    {
+        return ok;
+    }
+};
+
+}; // namespace detail
+
+}; // namespace mini_json
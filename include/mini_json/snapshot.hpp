@@ -0,0 +1,642 @@
+#pragma once
+#include "binary.hpp"
+#include "exception.hpp"
+#include "file.hpp"
+#include "json.hpp"
+#include "node.hpp"
+#include "sink.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mini_json {
+
+/**
+ * snapshot is a node tree laid out in one position independent buffer,
+ * so it can be written to a file, mapped back and read in place
+ * without parsing or building anything
+ * all numbers are little-endian and all offsets are from the start
+ *     header    "mjsn", version (u32), size (u64) and the root slot (u64)
+ *     slot      the type in the high byte and a payload in the low 56 bits
+ *         'n' 't' 'f'    null, true and false
+ *         'i'            an integer that fits in 56 bits, held in place
+ *         'l' 'u' 'd'    offset of an int64, uint64 or double
+ *         '"'            offset of a string
+ *         '[' '{'        offset of an array or object
+ *     string    length (u64), the bytes, a '\0' and padding to 8 bytes
+ *     array     count (u64) followed by a slot for every element
+ *     object    count (u64) followed by a key string offset and a value
+ *               slot for every member, sorted by key for binary search
+ * equal strings are stored once, and every array and object comes
+ * after the one holding it, so a walk down the tree always moves forward
+ * members iterate in key order rather than the order they were built in
+ * malformed data is found as it is read and throws bad_snapshot
+ */
+class snapshot {
+
+public:
+    class view;
+    class iterator;
+
+private:
+    constexpr static char magic[4] = { 'm', 'j', 's', 'n' };
+    constexpr static std::uint32_t version = 1;
+    constexpr static std::size_t header_size = 24;
+    constexpr static std::uint64_t payload_mask = (std::uint64_t(1) << 56) - 1;
+
+    class encoder;
+
+    std::string owned;
+    mapped_file file;
+    char const* base = nullptr;
+    std::size_t bytes = 0;
+
+    void attach(char const* data, std::size_t size)
+    {
+        if (size < header_size || std::memcmp(data, magic, sizeof magic) != 0
+            || detail::load_le<std::uint32_t>(data + 4) != version
+            || detail::load_le<std::uint64_t>(data + 8) > size)
+            throw bad_snapshot();
+
+        base = data;
+        bytes = static_cast<std::size_t>(detail::load_le<std::uint64_t>(data + 8));
+    }
+
+public:
+    snapshot() = default;
+
+    /**
+     * snapshot owns the encoded bytes in data
+     * throws bad_snapshot if they do not start with a valid header
+     */
+    explicit snapshot(std::string data)
+        : owned(std::move(data))
+    {
+        attach(owned.data(), owned.size());
+    }
+
+    snapshot(snapshot&& src) noexcept
+        : owned(std::move(src.owned))
+        , file(std::move(src.file))
+        , base(std::exchange(src.base, nullptr))
+        , bytes(std::exchange(src.bytes, 0))
+    {
+        if (!owned.empty())
+            base = owned.data();
+    }
+
+    snapshot& operator=(snapshot&& src) noexcept
+    {
+        if (this != &src) {
+            owned = std::move(src.owned);
+            file = std::move(src.file);
+            base = std::exchange(src.base, nullptr);
+            bytes = std::exchange(src.bytes, 0);
+            if (!owned.empty())
+                base = owned.data();
+        }
+        return *this;
+    }
+
+    /**
+     * snapshot refers to input without copying it
+     * input must outlive the snapshot and every view of it
+     */
+    static snapshot from_view(std::string_view input)
+    {
+        snapshot ret;
+        ret.attach(input.data(), input.size());
+        return ret;
+    }
+
+    /**
+     * map the file at path for random access, only the pages
+     * that are visited are ever read in
+     * throws std::system_error if it cannot be opened or mapped
+     */
+    static snapshot from_file(std::string const& path)
+    {
+        snapshot ret;
+        ret.file = mapped_file(path, mapped_file::access::random);
+        ret.attach(ret.file.data(), ret.file.size());
+        return ret;
+    }
+
+    /**
+     * encode root into a snapshot and write it to sink
+     */
+    template <typename Sink>
+    static bool write(node const& root, Sink& sink)
+    {
+        std::string out = encode(root);
+        return sink.write(out.data(), out.size());
+    }
+
+    static std::string encode(node const& root);
+
+    /**
+     * parse json text and encode it, throws bad_parse if it is not json
+     */
+    static std::string from_json(std::string_view text)
+    {
+        json doc = json::from_view(text);
+        node* root = doc.parse();
+        if (!root)
+            throw bad_parse();
+        return encode(*root);
+    }
+
+    /**
+     * the root value, only valid for a snapshot that holds data
+     */
+    view root() const;
+
+    std::string_view data() const noexcept
+    {
+        return std::string_view(base, bytes);
+    }
+
+    bool empty() const noexcept
+    {
+        return bytes == 0;
+    }
+};
+
+/**
+ * encoder lays a tree out in preorder, so a container is reserved first
+ * and its slots are filled in as its children are written after it
+ */
+class snapshot::encoder {
+
+private:
+    std::string& out;
+    // offsets of the strings written so far
+    std::unordered_map<std::string_view, std::uint64_t> strings;
+
+    std::uint64_t alloc(std::size_t size)
+    {
+        auto off = out.size();
+        out.resize(off + ((size + 7) & ~std::size_t(7)));
+        return off;
+    }
+
+    void store(std::uint64_t off, std::uint64_t val) noexcept
+    {
+        detail::store_le(out.data() + off, val);
+    }
+
+    static std::uint64_t slot(char type, std::uint64_t load = 0) noexcept
+    {
+        return (std::uint64_t(static_cast<unsigned char>(type)) << 56) | load;
+    }
+
+    std::uint64_t string(std::string_view str)
+    {
+        auto [it, fresh] = strings.try_emplace(str, 0);
+        if (fresh) {
+            // the padding is already zero, and so is the terminator
+            it->second = alloc(8 + str.size() + 1);
+            store(it->second, str.size());
+            std::memcpy(out.data() + it->second + 8, str.data(), str.size());
+        }
+        return it->second;
+    }
+
+    template <typename T>
+    std::uint64_t number(char type, T val)
+    {
+        std::uint64_t raw;
+        std::memcpy(&raw, &val, sizeof raw);
+
+        auto off = alloc(8);
+        store(off, raw);
+        return slot(type, off);
+    }
+
+    std::uint64_t value(node const& mnode)
+    {
+        switch (mnode.type()) {
+        case node::data_k::null:
+            return slot('n');
+
+        case node::data_k::boolean:
+            return slot(mnode.get<bool>() ? 't' : 'f');
+
+        case node::data_k::integer: {
+            auto val = mnode.get<node::int_t>();
+            if (val >= -(node::int_t(1) << 55) && val < (node::int_t(1) << 55))
+                return slot('i', std::uint64_t(val) & payload_mask);
+            return number('l', val);
+        }
+
+        case node::data_k::uinteger:
+            return number('u', mnode.get<node::uint_t>());
+
+        case node::data_k::number:
+            return number('d', mnode.get<node::num_t>());
+
+        case node::data_k::string:
+            return slot('\"', string(mnode.get<node::str_t>()));
+
+        case node::data_k::view:
+            return slot('\"', string(mnode.get<node::view_t>()));
+
+        case node::data_k::array: {
+            auto& arr = mnode.get<node::arr_t>();
+            auto off = alloc(8 + 8 * arr.size());
+            store(off, arr.size());
+
+            for (std::size_t i = 0; i < arr.size(); ++i) {
+                auto got = value(arr[i]);
+                store(off + 8 + 8 * i, got);
+            }
+            return slot('[', off);
+        }
+
+        case node::data_k::object:
+        default: {
+            auto& obj = mnode.get<node::obj_t>();
+            std::vector<node::obj_t::value_type const*> order;
+            order.reserve(obj.size());
+            for (auto& ent : obj)
+                order.push_back(&ent);
+            std::sort(order.begin(), order.end(), [](auto* lhs, auto* rhs) {
+                return std::string_view(lhs->first) < std::string_view(rhs->first);
+            });
+
+            auto off = alloc(8 + 16 * order.size());
+            store(off, order.size());
+
+            for (std::size_t i = 0; i < order.size(); ++i) {
+                auto key = string(order[i]->first);
+                store(off + 8 + 16 * i, key);
+                auto got = value(order[i]->second);
+                store(off + 16 + 16 * i, got);
+            }
+            return slot('{', off);
+        }
+        }
+    }
+
+public:
+    explicit encoder(std::string& out)
+        : out(out)
+    {
+    }
+
+    void run(node const& root)
+    {
+        auto head = alloc(header_size);
+        std::memcpy(out.data() + head, magic, sizeof magic);
+        detail::store_le(out.data() + head + 4, version);
+
+        auto got = value(root);
+        store(head + 8, out.size());
+        store(head + 16, got);
+    }
+};
+
+inline std::string snapshot::encode(node const& root)
+{
+    std::string ret;
+    encoder(ret).run(root);
+    return ret;
+}
+
+/**
+ * view is a value inside a snapshot, it offers the same accessors as
+ * tape::view, hands out strings as views of the snapshot and finds
+ * object members by binary search, without allocating
+ * it is only valid as long as the data of the snapshot is
+ */
+class snapshot::view {
+
+private:
+    char const* base = nullptr;
+    std::size_t bytes = 0;
+    std::uint64_t slot = 0;
+
+    friend class snapshot;
+    friend class snapshot::iterator;
+
+    view(char const* base, std::size_t bytes, std::uint64_t slot)
+        : base(base)
+        , bytes(bytes)
+        , slot(slot)
+    {
+        switch (kind()) {
+        case 'n':
+        case 't':
+        case 'f':
+        case 'i':
+        case 'l':
+        case 'u':
+        case 'd':
+        case '\"':
+        case '[':
+        case '{':
+            break;
+        default:
+            throw bad_snapshot();
+        }
+    }
+
+    char kind() const noexcept
+    {
+        return static_cast<char>(slot >> 56);
+    }
+
+    std::uint64_t offset() const noexcept
+    {
+        return slot & payload_mask;
+    }
+
+    std::uint64_t word(std::uint64_t off) const
+    {
+        if (off > bytes || bytes - off < 8)
+            throw bad_snapshot();
+        return detail::load_le<std::uint64_t>(base + off);
+    }
+
+    template <typename T>
+    T bits() const
+    {
+        auto raw = word(offset());
+        T val;
+        std::memcpy(&val, &raw, sizeof val);
+        return val;
+    }
+
+    std::string_view string(std::uint64_t off) const
+    {
+        auto len = word(off);
+        if (len > bytes - off - 8)
+            throw bad_snapshot();
+        return std::string_view(base + off + 8, static_cast<std::size_t>(len));
+    }
+
+    // entries of an array or object, each of stride bytes
+    std::size_t count(std::size_t stride) const
+    {
+        auto off = offset();
+        auto cnt = word(off);
+        if (cnt > (bytes - off - 8) / stride)
+            throw bad_snapshot();
+        return static_cast<std::size_t>(cnt);
+    }
+
+    std::size_t stride() const
+    {
+        switch (kind()) {
+        case '[':
+            return 8;
+        case '{':
+            return 16;
+        default:
+            throw bad_get();
+        }
+    }
+
+    // the value in the slot at off, a container must come after this one
+    view child(std::uint64_t off) const
+    {
+        view ret(base, bytes, word(off));
+        if ((ret.kind() == '[' || ret.kind() == '{') && ret.offset() <= offset())
+            throw bad_snapshot();
+        return ret;
+    }
+
+public:
+    view() = default;
+
+    node::data_k type() const noexcept
+    {
+        switch (kind()) {
+        case 'n':
+            return node::data_k::null;
+        case 't':
+        case 'f':
+            return node::data_k::boolean;
+        case 'i':
+        case 'l':
+            return node::data_k::integer;
+        case 'u':
+            return node::data_k::uinteger;
+        case 'd':
+            return node::data_k::number;
+        case '\"':
+            return node::data_k::string;
+        case '[':
+            return node::data_k::array;
+        default:
+            return node::data_k::object;
+        }
+    }
+
+    template <typename T>
+    T as() const
+    {
+        switch (kind()) {
+        case 'n':
+            return detail::scalar_as<T>(nullptr);
+        case 't':
+        case 'f':
+            return detail::scalar_as<T>(kind() == 't');
+        case 'i':
+            // sign extend the 56 bits
+            return detail::scalar_as<T>(node::int_t(slot << 8) >> 8);
+        case 'l':
+            return detail::scalar_as<T>(bits<node::int_t>());
+        case 'u':
+            return detail::scalar_as<T>(bits<node::uint_t>());
+        case 'd':
+            return detail::scalar_as<T>(bits<node::num_t>());
+        case '\"':
+            return detail::scalar_as<T>(string(offset()));
+        }
+
+        throw bad_as();
+    }
+
+    // number of elements or members, only for arrays and objects
+    std::size_t size() const
+    {
+        return count(stride());
+    }
+
+    iterator begin() const;
+    iterator end() const;
+
+    view operator[](std::size_t idx) const
+    {
+        if (kind() != '[')
+            throw bad_get();
+        if (idx >= count(8))
+            throw std::out_of_range("mini_json::snapshot::view : index out of range");
+        return child(offset() + 8 + 8 * idx);
+    }
+
+    std::optional<view> find(std::string_view key) const
+    {
+        if (kind() != '{')
+            throw bad_get();
+
+        std::size_t lo = 0, hi = count(16);
+        while (lo < hi) {
+            std::size_t mid = lo + (hi - lo) / 2;
+            auto entry = offset() + 8 + 16 * mid;
+            auto got = string(word(entry));
+
+            if (got < key)
+                lo = mid + 1;
+            else if (key < got)
+                hi = mid;
+            else
+                return child(entry + 8);
+        }
+
+        return std::nullopt;
+    }
+
+    view operator[](std::string_view key) const
+    {
+        if (auto got = find(key); got)
+            return *got;
+
+        throw std::out_of_range("mini_json::snapshot::view : key not found");
+    }
+
+    // build an owning node from this value and everything below it
+    node to_node() const;
+};
+
+/**
+ * iterator walks the elements of an array or the members of an object
+ * for object members, key() gives the key and * gives the value
+ */
+class snapshot::iterator {
+
+private:
+    view box;
+    // offset of the current entry
+    std::uint64_t pos = 0;
+
+    friend class snapshot::view;
+
+    iterator(view box, std::uint64_t pos)
+        : box(box)
+        , pos(pos)
+    {
+    }
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = view;
+    using reference = view;
+    using pointer = void;
+
+    iterator() = default;
+
+    view operator*() const
+    {
+        return box.child(box.kind() == '{' ? pos + 8 : pos);
+    }
+
+    std::string_view key() const
+    {
+        if (box.kind() != '{')
+            throw bad_get();
+        return box.string(box.word(pos));
+    }
+
+    iterator& operator++()
+    {
+        pos += box.kind() == '{' ? 16 : 8;
+        return *this;
+    }
+
+    iterator operator++(int)
+    {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(iterator const& rhs) const noexcept
+    {
+        return pos == rhs.pos;
+    }
+
+    bool operator!=(iterator const& rhs) const noexcept
+    {
+        return pos != rhs.pos;
+    }
+};
+
+inline snapshot::view snapshot::root() const
+{
+    if (!base)
+        throw bad_snapshot();
+    return view(base, bytes, detail::load_le<std::uint64_t>(base + 16));
+}
+
+inline snapshot::iterator snapshot::view::begin() const
+{
+    stride();
+    return iterator(*this, offset() + 8);
+}
+
+inline snapshot::iterator snapshot::view::end() const
+{
+    auto step = stride();
+    return iterator(*this, offset() + 8 + step * count(step));
+}
+
+inline node snapshot::view::to_node() const
+{
+    switch (kind()) {
+    case 'n':
+        return node(nullptr);
+    case 't':
+        return node(true);
+    case 'f':
+        return node(false);
+    case 'i':
+    case 'l':
+        return node(as<node::int_t>());
+    case 'u':
+        return node(bits<node::uint_t>());
+    case 'd':
+        return node(bits<node::num_t>());
+    case '\"':
+        return node(node::str_t(string(offset())));
+
+    case '[': {
+        node::arr_t arr;
+        arr.reserve(size());
+        for (auto it = begin(), ed = end(); it != ed; ++it)
+            arr.push_back((*it).to_node());
+        return node(std::move(arr));
+    }
+
+    default: {
+        node::obj_t obj;
+        obj.reserve(size());
+        for (auto it = begin(), ed = end(); it != ed; ++it)
+            obj.emplace(it.key(), (*it).to_node());
+        return node(std::move(obj));
+    }
+    }
+}
+
+}; // namespace mini_json
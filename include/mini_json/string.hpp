@@ -0,0 +1,202 @@
+#pragma once
+#include "scan.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace mini_json::detail {
+
+enum class string_error {
+    non,
+    unterminated,
+    invalid_escape,
+};
+
+/**
+ * append_utf8 appends a code point encoded as UTF-8
+ * and fails for anything beyond the unicode range
+ */
+template <typename Str>
+inline bool append_utf8(std::uint32_t code, Str& out)
+{
+    char tmp[4] = { 0 };
+    std::size_t len = 0;
+    if (code <= 0x7F) {
+        tmp[0] = char(code & 0xFF);
+        len = 1;
+    } else if (code <= 0x7FF) {
+        tmp[0] = char(0xC0 | ((code >> 6) & 0xFF));
+        tmp[1] = char(0x80 | (code & 0x3F));
+        len = 2;
+    } else if (code <= 0xFFFF) {
+        tmp[0] = char(0xE0 | ((code >> 12) & 0xFF));
+        tmp[1] = char(0x80 | ((code >> 6) & 0x3F));
+        tmp[2] = char(0x80 | (code & 0x3F));
+        len = 3;
+    } else if (code <= 0x10FFFF) {
+        tmp[0] = char(0xF0 | ((code >> 18) & 0xFF));
+        tmp[1] = char(0x80 | ((code >> 12) & 0x3F));
+        tmp[2] = char(0x80 | ((code >> 6) & 0x3F));
+        tmp[3] = char(0x80 | (code & 0x3F));
+        len = 4;
+    } else {
+        return false;
+    }
+
+    out.append(tmp, len);
+    return true;
+}
+
+// value of a hex digit, or -1
+inline int hex_value(char ch) noexcept
+{
+    if (ch >= '0' && ch <= '9')
+        return ch - '0';
+    if (ch >= 'a' && ch <= 'f')
+        return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F')
+        return ch - 'A' + 10;
+    return -1;
+}
+
+/**
+ * unescape decodes a json string into out, starting right after the
+ * opening quote and leaving it right after the closing one
+ * plain runs between escapes are found in blocks and copied at once
+ */
+template <typename Str>
+inline string_error unescape(char const*& it, char const* end, Str& out)
+{
+    out.clear();
+
+    while (true) {
+        char const* run = next_quote(it, end);
+
+        // most strings have no escape, so they need only one allocation
+        if (out.empty() && run != end && *run == '\"') {
+            out.assign(it, run);
+            it = run + 1;
+            return string_error::non;
+        }
+
+        // otherwise reserve room for the escapes before copying the run
+        if (out.empty())
+            out.reserve(2 * (run - it) + 16);
+        out.append(it, run);
+        it = run;
+
+        if (it == end)
+            return string_error::unterminated;
+
+        if (*it == '\"') {
+            ++it;
+            return string_error::non;
+        }
+
+        if (++it == end)
+            return string_error::unterminated;
+
+        switch (*it) {
+        case '\"':
+            out.push_back('\"');
+            break;
+        case '\\':
+            out.push_back('\\');
+            break;
+        case '/':
+            out.push_back('/');
+            break;
+        case 'b':
+            out.push_back('\b');
+            break;
+        case 'f':
+            out.push_back('\f');
+            break;
+        case 'n':
+            out.push_back('\n');
+            break;
+        case 'r':
+            out.push_back('\r');
+            break;
+        case 't':
+            out.push_back('\t');
+            break;
+        case 'u': {
+            // exactly four hex digits follow
+            if (end - it < 5)
+                return string_error::invalid_escape;
+
+            std::uint32_t code = 0;
+            for (int i = 1; i <= 4; ++i) {
+                int digit = hex_value(it[i]);
+                if (digit < 0)
+                    return string_error::invalid_escape;
+                code = code << 4 | std::uint32_t(digit);
+            }
+
+            append_utf8(code, out);
+            it += 4;
+            break;
+        }
+        default:
+            return string_error::invalid_escape;
+        }
+        ++it;
+    }
+}
+
+/**
+ * escape writes src to out as a quoted json string
+ * clean runs are found in blocks and appended at once
+ */
+template <typename Out>
+inline void escape(Out& out, std::string_view src)
+{
+    constexpr char hex[] = "0123456789abcdef";
+    char const* it = src.data();
+    char const* end = it + src.size();
+
+    out.put('\"');
+
+    while (true) {
+        char const* run = detail::next_escape(it, end);
+        out.append(it, run - it);
+        if (run == end)
+            break;
+
+        switch (*run) {
+        case '\"':
+            out.append("\\\"", 2);
+            break;
+        case '\\':
+            out.append("\\\\", 2);
+            break;
+        case '\b':
+            out.append("\\b", 2);
+            break;
+        case '\f':
+            out.append("\\f", 2);
+            break;
+        case '\n':
+            out.append("\\n", 2);
+            break;
+        case '\r':
+            out.append("\\r", 2);
+            break;
+        case '\t':
+            out.append("\\t", 2);
+            break;
+        default: {
+            auto ch = static_cast<unsigned char>(*run);
+            char buf[6] = { '\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0xF] };
+            out.append(buf, 6);
+            break;
+        }
+        }
+        it = run + 1;
+    }
+
+    out.put('\"');
+}
+
+}; // namespace mini_json::detail
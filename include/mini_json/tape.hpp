@@ -0,0 +1,466 @@
+#pragma once
+#include "exception.hpp"
+#include "node.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace mini_json {
+
+/**
+ * tape is a flat, read-only alternative to the node tree
+ * every value takes one or two 64-bit entries in a single vector
+ * the type is kept in the high byte and a payload in the low 56 bits
+ *     'n' 't' 'f'    null, true and false
+ *     'l' 'u' 'd'    int64, uint64 and double, the bits are in the next entry
+ *     '"'            offset of the string in strings
+ *     '[' '{'        index after the matching end
+ *     ']' '}'        element count
+ * keys of an object are string entries right before their values
+ * strings hold a 64-bit length followed by the bytes
+ */
+class tape {
+
+public:
+    class view;
+    class iterator;
+
+    friend class json;
+
+    /**
+     * the root value, only valid for a non-empty tape
+     */
+    view root() const;
+
+    bool empty() const noexcept
+    {
+        return entries.empty();
+    }
+
+    void clear() noexcept
+    {
+        entries.clear();
+        strings.clear();
+    }
+
+private:
+    constexpr static std::uint64_t payload_mask = (std::uint64_t(1) << 56) - 1;
+
+    std::vector<std::uint64_t> entries;
+    std::vector<char> strings;
+
+    char kind(std::size_t pos) const noexcept
+    {
+        return static_cast<char>(entries[pos] >> 56);
+    }
+
+    std::uint64_t payload(std::size_t pos) const noexcept
+    {
+        return entries[pos] & payload_mask;
+    }
+
+    // index of the entry after the value at pos
+    std::size_t next(std::size_t pos) const noexcept
+    {
+        switch (kind(pos)) {
+        case '[':
+        case '{':
+            return static_cast<std::size_t>(payload(pos));
+
+        case 'l':
+        case 'u':
+        case 'd':
+            return pos + 2;
+
+        default:
+            return pos + 1;
+        }
+    }
+
+    std::string_view string(std::size_t pos) const noexcept
+    {
+        std::uint64_t len = 0;
+        char const* st = strings.data() + payload(pos);
+        std::memcpy(&len, st, sizeof len);
+        return std::string_view(st + sizeof len, static_cast<std::size_t>(len));
+    }
+
+    template <typename T>
+    T bits(std::size_t pos) const noexcept
+    {
+        T val;
+        std::memcpy(&val, &entries[pos + 1], sizeof val);
+        return val;
+    }
+
+    /**
+     * submethods used by builder while building a tape
+     */
+    void push(char type, std::uint64_t load = 0)
+    {
+        entries.push_back((std::uint64_t(static_cast<unsigned char>(type)) << 56) | load);
+    }
+
+    template <typename T>
+    void push_number(char type, T val)
+    {
+        std::uint64_t raw = 0;
+        std::memcpy(&raw, &val, sizeof val);
+        push(type);
+        entries.push_back(raw);
+    }
+
+    void push_string(char const* st, std::size_t len)
+    {
+        auto off = strings.size();
+        auto len64 = static_cast<std::uint64_t>(len);
+        strings.resize(off + sizeof len64 + len);
+        std::memcpy(strings.data() + off, &len64, sizeof len64);
+        std::memcpy(strings.data() + off + sizeof len64, st, len);
+        push('\"', off);
+    }
+
+    std::size_t open(char type)
+    {
+        push(type);
+        return entries.size() - 1;
+    }
+
+    void close(std::size_t start, std::size_t count)
+    {
+        char type = kind(start);
+        push(type == '[' ? ']' : '}', count);
+        entries[start] |= entries.size();
+    }
+
+    class builder;
+};
+
+/**
+ * builder is the handler json parses a tape with
+ */
+class tape::builder {
+
+private:
+    tape& doc;
+    // the entries of the containers not closed yet
+    std::vector<std::size_t> starts;
+
+    bool open(char type)
+    {
+        starts.push_back(doc.open(type));
+        return true;
+    }
+
+    bool close(std::size_t count)
+    {
+        doc.close(starts.back(), count);
+        starts.pop_back();
+        return true;
+    }
+
+public:
+    explicit builder(tape& doc)
+        : doc(doc)
+    {
+    }
+
+    bool null()
+    {
+        doc.push('n');
+        return true;
+    }
+
+    bool boolean(bool val)
+    {
+        doc.push(val ? 't' : 'f');
+        return true;
+    }
+
+    bool integer(node::int_t val)
+    {
+        doc.push_number('l', val);
+        return true;
+    }
+
+    bool uinteger(node::uint_t val)
+    {
+        doc.push_number('u', val);
+        return true;
+    }
+
+    bool number(node::num_t val)
+    {
+        doc.push_number('d', val);
+        return true;
+    }
+
+    bool string(std::string_view val)
+    {
+        doc.push_string(val.data(), val.size());
+        return true;
+    }
+
+    bool key(std::string_view val)
+    {
+        return string(val);
+    }
+
+    bool start_object() { return open('{'); }
+    bool start_array() { return open('['); }
+    bool end_object(std::size_t count) { return close(count); }
+    bool end_array(std::size_t count) { return close(count); }
+};
+
+/**
+ * view is a lightweight reference to one value on a tape
+ * it offers the same get-style accessors as node
+ * and is only valid as long as the tape is not modified
+ */
+class tape::view {
+
+private:
+    tape const* doc = nullptr;
+    std::size_t pos = 0;
+
+    friend class tape;
+    friend class tape::iterator;
+
+    view(tape const* doc, std::size_t pos)
+        : doc(doc)
+        , pos(pos)
+    {
+    }
+
+public:
+    view() = default;
+
+    node::data_k type() const
+    {
+        switch (doc->kind(pos)) {
+        case 'n':
+            return node::data_k::null;
+        case 't':
+        case 'f':
+            return node::data_k::boolean;
+        case 'l':
+            return node::data_k::integer;
+        case 'u':
+            return node::data_k::uinteger;
+        case 'd':
+            return node::data_k::number;
+        case '\"':
+            return node::data_k::string;
+        case '[':
+            return node::data_k::array;
+        default:
+            return node::data_k::object;
+        }
+    }
+
+    template <typename T>
+    T as() const
+    {
+        switch (doc->kind(pos)) {
+        case 'n':
+            return detail::scalar_as<T>(nullptr);
+        case 't':
+        case 'f':
+            return detail::scalar_as<T>(doc->kind(pos) == 't');
+        case 'l':
+            return detail::scalar_as<T>(doc->bits<node::int_t>(pos));
+        case 'u':
+            return detail::scalar_as<T>(doc->bits<node::uint_t>(pos));
+        case 'd':
+            return detail::scalar_as<T>(doc->bits<node::num_t>(pos));
+        case '\"':
+            return detail::scalar_as<T>(doc->string(pos));
+        }
+
+        throw bad_as();
+    }
+
+    // number of elements or members, only for arrays and objects
+    std::size_t size() const;
+
+    iterator begin() const;
+    iterator end() const;
+
+    view operator[](std::size_t idx) const;
+    view operator[](std::string_view key) const;
+    std::optional<view> find(std::string_view key) const;
+
+    // build an owning node from this value and everything below it
+    node to_node() const;
+};
+
+/**
+ * iterator walks the elements of an array or the members of an object
+ * for object members, key() gives the key and * gives the value
+ */
+class tape::iterator {
+
+private:
+    tape const* doc = nullptr;
+    std::size_t pos = 0;
+    bool member = false;
+
+    friend class tape::view;
+
+    iterator(tape const* doc, std::size_t pos, bool member)
+        : doc(doc)
+        , pos(pos)
+        , member(member)
+    {
+    }
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = view;
+    using reference = view;
+    using pointer = void;
+
+    iterator() = default;
+
+    view operator*() const
+    {
+        return view(doc, member ? pos + 1 : pos);
+    }
+
+    std::string_view key() const
+    {
+        if (!member)
+            throw bad_get();
+        return doc->string(pos);
+    }
+
+    iterator& operator++()
+    {
+        pos = doc->next(member ? pos + 1 : pos);
+        return *this;
+    }
+
+    iterator operator++(int)
+    {
+        auto tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator==(iterator const& rhs) const noexcept
+    {
+        return pos == rhs.pos;
+    }
+
+    bool operator!=(iterator const& rhs) const noexcept
+    {
+        return pos != rhs.pos;
+    }
+};
+
+inline tape::view tape::root() const
+{
+    return view(this, 0);
+}
+
+inline tape::iterator tape::view::begin() const
+{
+    char type = doc->kind(pos);
+    if (type != '[' && type != '{')
+        throw bad_get();
+    return iterator(doc, pos + 1, type == '{');
+}
+
+inline tape::iterator tape::view::end() const
+{
+    char type = doc->kind(pos);
+    if (type != '[' && type != '{')
+        throw bad_get();
+    return iterator(doc, doc->next(pos) - 1, type == '{');
+}
+
+inline std::size_t tape::view::size() const
+{
+    char type = doc->kind(pos);
+    if (type != '[' && type != '{')
+        throw bad_get();
+
+    // the count is kept by the matching end
+    return static_cast<std::size_t>(doc->payload(doc->next(pos) - 1));
+}
+
+inline tape::view tape::view::operator[](std::size_t idx) const
+{
+    if (doc->kind(pos) != '[')
+        throw bad_get();
+
+    for (auto it = begin(), ed = end(); it != ed; ++it, --idx)
+        if (idx == 0)
+            return *it;
+
+    throw std::out_of_range("mini_json::tape::view : index out of range");
+}
+
+inline std::optional<tape::view> tape::view::find(std::string_view key) const
+{
+    if (doc->kind(pos) != '{')
+        throw bad_get();
+
+    for (auto it = begin(), ed = end(); it != ed; ++it)
+        if (it.key() == key)
+            return *it;
+
+    return std::nullopt;
+}
+
+inline tape::view tape::view::operator[](std::string_view key) const
+{
+    if (auto got = find(key); got)
+        return *got;
+
+    throw std::out_of_range("mini_json::tape::view : key not found");
+}
+
+inline node tape::view::to_node() const
+{
+    switch (doc->kind(pos)) {
+    case 'n':
+        return node(nullptr);
+    case 't':
+        return node(true);
+    case 'f':
+        return node(false);
+    case 'l':
+        return node(doc->bits<node::int_t>(pos));
+    case 'u':
+        return node(doc->bits<node::uint_t>(pos));
+    case 'd':
+        return node(doc->bits<node::num_t>(pos));
+    case '\"':
+        return node(node::str_t(doc->string(pos)));
+
+    case '[': {
+        node::arr_t arr;
+        arr.reserve(size());
+        for (auto it = begin(), ed = end(); it != ed; ++it)
+            arr.push_back((*it).to_node());
+        return node(std::move(arr));
+    }
+
+    default: {
+        node::obj_t obj;
+        obj.reserve(size());
+        for (auto it = begin(), ed = end(); it != ed; ++it)
+            obj.emplace(it.key(), (*it).to_node());
+        return node(std::move(obj));
+    }
+    }
+}
+
+}; // namespace mini_json
@@ -0,0 +1,167 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace mini_mpf {
+
+/**
+ * key_map is a perfect hash over a fixed set of keys, built at compile time
+ *     constexpr static std::string_view names[] = { "id", "name", "tags" };
+ *     constexpr static key_map keys { names };
+ *     keys.find("name") == 1
+ * the hash only reads the length and a few bytes at positions chosen so
+ * that they tell every key apart, a seed is searched for that sends each
+ * key to its own slot, and one comparison confirms the key found there
+ * building fails to compile for duplicate keys
+ */
+template <std::size_t N>
+class key_map {
+
+    static_assert(N > 0, "a key map needs at least one key");
+
+public:
+    constexpr static std::size_t npos = std::size_t(-1);
+
+private:
+    using index_t = std::conditional_t<(N < 255), std::uint8_t, std::uint16_t>;
+
+    constexpr static index_t empty = index_t(-1);
+    // bytes of the keys the hash may look at, counted from the end if negative
+    constexpr static std::size_t max_positions = 16;
+
+    constexpr static unsigned ceil_log2(std::size_t val) noexcept
+    {
+        unsigned ret = 0;
+        while ((std::size_t(1) << ret) < val)
+            ++ret;
+        return ret;
+    }
+
+    // at least four slots a key, and up to three doublings while searching
+    constexpr static unsigned min_bits = ceil_log2(N) + 2;
+    constexpr static unsigned max_bits = min_bits + 3;
+    constexpr static std::size_t max_seeds = 4096;
+
+    std::string_view keys[N] = {};
+    int positions[max_positions] = {};
+    std::size_t count = 0;
+    std::uint64_t seed = 0;
+    unsigned shift = 64;
+    index_t table[std::size_t(1) << max_bits] = {};
+
+    constexpr static unsigned char byte_at(std::string_view key, int pos) noexcept
+    {
+        std::size_t at = pos >= 0 ? std::size_t(pos) : key.size() - std::size_t(-pos);
+        return at < key.size() ? static_cast<unsigned char>(key[at]) : 0;
+    }
+
+    constexpr std::uint64_t hash(std::string_view key, std::uint64_t with) const noexcept
+    {
+        std::uint64_t val = (with + key.size()) * 0x9E3779B97F4A7C15;
+        for (std::size_t i = 0; i < count; ++i)
+            val = (val ^ byte_at(key, positions[i])) * 0x100000001B3;
+
+        val ^= val >> 33;
+        val *= 0xFF51AFD7ED558CCD;
+        val ^= val >> 33;
+        return val;
+    }
+
+    // pairs of keys the current positions do not tell apart
+    constexpr std::size_t collisions() const noexcept
+    {
+        std::size_t ret = 0;
+        for (std::size_t i = 0; i < N; ++i)
+            for (std::size_t j = i + 1; j < N; ++j) {
+                bool same = keys[i].size() == keys[j].size();
+                for (std::size_t k = 0; same && k < count; ++k)
+                    same = byte_at(keys[i], positions[k]) == byte_at(keys[j], positions[k]);
+                ret += same;
+            }
+        return ret;
+    }
+
+    // add the positions that split the most keys until every key differs
+    constexpr void choose_positions()
+    {
+        std::size_t longest = 0;
+        for (auto key : keys)
+            longest = key.size() > longest ? key.size() : longest;
+
+        for (std::size_t left = collisions(); left;) {
+            if (count == max_positions)
+                throw std::invalid_argument("mini_mpf::key_map : keys are too alike");
+
+            int best = 0;
+            std::size_t best_left = left;
+            for (int pos = -int(longest); pos < int(longest); ++pos) {
+                positions[count++] = pos;
+                std::size_t got = collisions();
+                --count;
+                if (got < best_left)
+                    best = pos, best_left = got;
+            }
+
+            // duplicates are the only keys no position can split
+            if (best_left == left)
+                throw std::invalid_argument("mini_mpf::key_map : duplicate keys");
+
+            positions[count++] = best;
+            left = best_left;
+        }
+    }
+
+    constexpr bool try_seed(unsigned bits, std::uint64_t with)
+    {
+        for (std::size_t i = 0; i < (std::size_t(1) << bits); ++i)
+            table[i] = empty;
+
+        for (std::size_t i = 0; i < N; ++i) {
+            auto slot = hash(keys[i], with) >> (64 - bits);
+            if (table[slot] != empty)
+                return false;
+            table[slot] = index_t(i);
+        }
+        return true;
+    }
+
+public:
+    constexpr explicit key_map(std::string_view const (&src)[N])
+    {
+        for (std::size_t i = 0; i < N; ++i)
+            keys[i] = src[i];
+
+        choose_positions();
+
+        for (unsigned bits = min_bits; bits <= max_bits; ++bits)
+            for (std::uint64_t with = 0; with < max_seeds; ++with)
+                if (try_seed(bits, with)) {
+                    seed = with;
+                    shift = 64 - bits;
+                    return;
+                }
+
+        throw std::invalid_argument("mini_mpf::key_map : no perfect hash found");
+    }
+
+    // len will return the number of keys
+    constexpr static std::size_t len() noexcept
+    {
+        return N;
+    }
+
+    // find will return the index of key in the keys given, or npos
+    constexpr std::size_t find(std::string_view key) const noexcept
+    {
+        index_t got = table[hash(key, seed) >> shift];
+        return got != empty && keys[got] == key ? got : npos;
+    }
+};
+
+template <std::size_t N>
+key_map(std::string_view const (&)[N]) -> key_map<N>;
+
+};
@@ -1,30 +1,486 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/benchmark/catch_benchmark_all.hpp>
 
-#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <mini_json/array_parser.hpp>
+#include <mini_json/bind.hpp>
+#include <mini_json/cbor.hpp>
 #include <mini_json/json.hpp>
+#include <mini_json/lazy.hpp>
+#include <mini_json/msgpack.hpp>
+#include <mini_json/ndjson.hpp>
+#include <mini_json/pointer.hpp>
+#include <mini_json/push_parser.hpp>
+#include <mini_json/snapshot.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace json = mini_json;
 
+// build an array of records indented like a pretty-printer would do
+static std::string make_indented(std::size_t records, std::size_t indent)
+{
+    std::string pad(indent, ' ');
+    std::string ret = "[\n";
 
-TEST_CASE("json test", "[benchmark]")
+    for (std::size_t i = 0; i < records; ++i) {
+        ret += pad + "{\n";
+        ret += pad + pad + "\"id\": " + std::to_string(i) + ",\n";
+        ret += pad + pad + "\"name\": \"record\",\n";
+        ret += pad + pad + "\"tags\": [\n";
+        ret += pad + pad + pad + "true,\n";
+        ret += pad + pad + pad + "null\n";
+        ret += pad + pad + "]\n";
+        ret += pad + (i + 1 == records ? "}\n" : "},\n");
+    }
+
+    return ret + "]\n";
+}
+
+// build a geojson-like polygon collection, almost all numbers
+static std::string make_coordinates(std::size_t features, std::size_t points)
 {
-    std::ifstream fs("../test/demo/test2.json");
-    if (!fs.is_open())
-        throw std::runtime_error("Can't open file");
+    std::string ret = "{\"type\": \"FeatureCollection\", \"features\": [";
+    std::uint64_t seed = 42;
+
+    for (std::size_t i = 0; i < features; ++i) {
+        ret += i ? ", " : "";
+        ret += "{\"type\": \"Feature\", \"geometry\": {\"type\": \"Polygon\", \"coordinates\": [[";
+
+        for (std::size_t j = 0; j < points; ++j) {
+            seed = seed * 6364136223846793005u + 1442695040888963407u;
+            double lon = -180.0 + double(seed >> 11) / double(1ull << 53) * 360.0;
+            double lat = -90.0 + double((seed >> 7) & 0xFFFFFFFF) / 4294967296.0 * 180.0;
+
+            char buf[64];
+            std::snprintf(buf, sizeof buf, "%s[%.8f, %.8f]", j ? ", " : "", lon, lat);
+            ret += buf;
+        }
+
+        ret += "]]}}";
+    }
+
+    return ret + "]}";
+}
+
+// build log-like records, almost all strings
+static std::string make_strings(std::size_t records)
+{
+    std::string ret = "[";
+
+    for (std::size_t i = 0; i < records; ++i) {
+        ret += i ? ", " : "";
+        ret += "{\"level\": \"info\", \"message\": \"request " + std::to_string(i) + " served from cache in the edge location\", ";
+        ret += "\"agent\": \"Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36\", ";
+        ret += "\"path\": \"\\/api\\/v1\\/items?id=" + std::to_string(i) + "\\n\"}";
+    }
+
+    return ret + "]";
+}
+
+// build json lines, one small record each
+static std::string make_lines(std::size_t records)
+{
+    std::string ret;
+
+    for (std::size_t i = 0; i < records; ++i) {
+        ret += "{\"id\": " + std::to_string(i) + ", \"level\": \"warn\", \"latency\": 0." + std::to_string(i % 997);
+        ret += ", \"tags\": [\"edge\", \"cache\"], \"user\": {\"name\": \"arthur\", \"admin\": false}}\n";
+    }
+
+    return ret;
+}
+
+// a handler that only sums up the length of every string
+struct counter {
+    std::size_t chars = 0;
+
+    bool null() { return true; }
+    bool boolean(bool) { return true; }
+    bool integer(json::node::int_t) { return true; }
+    bool uinteger(json::node::uint_t) { return true; }
+    bool number(json::node::num_t) { return true; }
+    bool key(std::string_view) { return true; }
+    bool start_object() { return true; }
+    bool end_object(std::size_t) { return true; }
+    bool start_array() { return true; }
+    bool end_array(std::size_t) { return true; }
 
-    std::string con { std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>() };
-    json::json obj(std::move(con));
+    bool string(std::string_view val)
+    {
+        chars += val.size();
+        return true;
+    }
+};
+
+TEST_CASE("json test", "[benchmark]")
+{
+    auto obj = json::json::from_file("../test/demo/test2.json");
 
     BENCHMARK("test json parse")
     {
         auto ret = obj.parse();
         return true;
     };
+
+    auto arena = json::json::from_file("../test/demo/test2.json", { true });
+
+    BENCHMARK("test json parse (arena)")
+    {
+        return arena.parse();
+    };
+
+    json::tape doc;
+
+    BENCHMARK("test json parse (tape)")
+    {
+        return obj.parse(doc);
+    };
     
     BENCHMARK("test json stringify")
     {
         auto ret = obj.str();
         return true;
     };
-}
\ No newline at end of file
+}
+
+TEST_CASE("indented json test", "[benchmark]")
+{
+    json::json narrow(make_indented(20000, 2));
+    json::json wide(make_indented(20000, 8));
+
+    BENCHMARK("test json parse (indent 2)")
+    {
+        return narrow.parse();
+    };
+
+    BENCHMARK("test json parse (indent 8)")
+    {
+        return wide.parse();
+    };
+
+    json::json interned(make_indented(20000, 2), { true, false, true });
+
+    BENCHMARK("test json parse (interned keys)")
+    {
+        return interned.parse();
+    };
+}
+
+TEST_CASE("number json test", "[benchmark]")
+{
+    json::json obj(make_coordinates(1000, 100));
+
+    BENCHMARK("test json parse (coordinates)")
+    {
+        return obj.parse();
+    };
+}
+
+TEST_CASE("string json test", "[benchmark]")
+{
+    json::json obj(make_strings(20000));
+    obj.parse();
+
+    BENCHMARK("test json parse (strings)")
+    {
+        return obj.parse();
+    };
+
+    json::json arena(make_strings(20000), { true });
+
+    BENCHMARK("test json parse (strings, arena)")
+    {
+        return arena.parse();
+    };
+
+    json::tape doc;
+
+    BENCHMARK("test json parse (strings, tape)")
+    {
+        return obj.parse(doc);
+    };
+
+    BENCHMARK("test json parse (strings, sax)")
+    {
+        counter cnt;
+        obj.parse(cnt);
+        return cnt.chars;
+    };
+
+    std::string chunked = make_strings(20000);
+
+    BENCHMARK("test json parse (strings, push 4k)")
+    {
+        counter cnt;
+        json::push_parser<counter> parser(cnt);
+        for (std::size_t pos = 0; pos < chunked.size(); pos += 4096)
+            parser.feed(std::string_view(chunked).substr(pos, 4096));
+        parser.finish();
+        return cnt.chars;
+    };
+
+    json::json insitu(make_strings(20000), { true, true });
+
+    BENCHMARK("test json parse (insitu)")
+    {
+        return insitu.parse();
+    };
+
+    BENCHMARK("test json stringify (strings)")
+    {
+        return obj.str();
+    };
+
+    BENCHMARK("test json write (strings, callback)")
+    {
+        std::size_t bytes = 0;
+        json::callback_sink sink([&bytes](std::string_view block) { bytes += block.size(); });
+        obj.write(sink);
+        return bytes;
+    };
+
+    BENCHMARK("test json write (exact)")
+    {
+        std::string out(obj.str_size(), '\0');
+        json::buffer_sink sink(out.data(), out.size());
+        obj.write(sink);
+        return out;
+    };
+}
+
+TEST_CASE("lazy test", "[benchmark]")
+{
+    json::mapped_file file("../test/demo/test2.json");
+    std::string_view input(file.data(), file.size());
+
+    BENCHMARK("test json parse (few fields)")
+    {
+        auto obj = json::json::from_view(input);
+        auto& last = obj.parse()->get<json::node::arr_t>().back();
+        return last.get<json::node::obj_t>().at("comment").get<json::node::str_t>().size();
+    };
+
+    BENCHMARK("test lazy lookup (few fields)")
+    {
+        json::lazy doc(input);
+        return doc[88]["comment"].as<std::string_view>().size();
+    };
+}
+
+TEST_CASE("pointer test", "[benchmark]")
+{
+    std::string lines = make_lines(10000);
+    std::vector<std::string_view> docs;
+    for (std::size_t first = 0, last; first < lines.size(); first = last + 1) {
+        last = lines.find('\n', first);
+        docs.emplace_back(lines.data() + first, last - first);
+    }
+
+    json::json parser("");
+    json::query route { "/id", "/level", "/user/name" };
+
+    BENCHMARK("test json parse (route)")
+    {
+        std::size_t chars = 0;
+        for (auto doc : docs) {
+            parser.reset_view(doc);
+            auto& obj = parser.parse()->get<json::node::obj_t>();
+            chars += obj.at("id").as<std::size_t>();
+            chars += obj.at("level").as<std::string_view>().size();
+            chars += obj.at("user").get<json::node::obj_t>().at("name").as<std::string_view>().size();
+        }
+        return chars;
+    };
+
+    BENCHMARK("test query run (route)")
+    {
+        std::size_t chars = 0;
+        for (auto doc : docs)
+            route.run(json::lazy(doc), [&chars](std::size_t which, json::lazy val) {
+                chars += which == 0 ? val.as<std::size_t>() : val.as<std::string_view>().size();
+            });
+        return chars;
+    };
+}
+
+TEST_CASE("binary test", "[benchmark]")
+{
+    json::msgpack pack;
+    json::cbor cbor;
+    json::node got;
+
+    auto demo = json::json::from_file("../test/demo/test2.json");
+    json::json coords(make_coordinates(1000, 100));
+    json::json strings(make_strings(20000));
+
+    for (auto* doc : { &demo, &coords, &strings }) {
+        std::string name = doc == &demo ? "(test2)" : doc == &coords ? "(numbers)" : "(strings)";
+        json::node& root = *doc->parse();
+        std::string text = *doc->str();
+
+        BENCHMARK("test json round trip " + name)
+        {
+            json::json again(text);
+            again.parse();
+            return again.str()->size();
+        };
+
+        // decode to a node and encode it again, like parse and str
+        std::string packed = pack.encode(root);
+        BENCHMARK("test msgpack round trip " + name)
+        {
+            pack.decode(packed, got);
+            return pack.encode(got).size();
+        };
+
+        std::string encoded = cbor.encode(root);
+        BENCHMARK("test cbor round trip " + name)
+        {
+            cbor.decode(encoded, got);
+            return cbor.encode(got).size();
+        };
+    }
+}
+
+struct log_record {
+    std::string level;
+    std::string message;
+    std::string agent;
+    std::string path;
+};
+
+MINI_JSON_BIND(log_record, level, message, agent, path)
+
+struct telemetry {
+    std::uint64_t device;
+    std::uint64_t timestamp;
+    double temperature;
+    double humidity;
+    double pressure;
+    int battery;
+    int signal;
+    bool charging;
+    std::string firmware;
+    std::string region;
+};
+
+MINI_JSON_BIND(telemetry, device, timestamp, temperature, humidity, pressure, battery, signal, charging, firmware, region)
+
+// build telemetry messages whose keys come in another order than declared
+static std::string make_telemetry(std::size_t records)
+{
+    std::string ret = "[";
+
+    for (std::size_t i = 0; i < records; ++i) {
+        ret += i ? ", " : "";
+        ret += "{\"region\": \"eu\", \"signal\": -" + std::to_string(i % 90) + ", \"humidity\": 0.4" + std::to_string(i % 10);
+        ret += ", \"device\": " + std::to_string(i) + ", \"charging\": false, \"firmware\": \"1.2.3\"";
+        ret += ", \"pressure\": 1013.25, \"timestamp\": 1700000000, \"battery\": 87, \"temperature\": 21.5}";
+    }
+
+    return ret + "]";
+}
+
+TEST_CASE("bind test", "[benchmark]")
+{
+    std::string text = make_strings(20000);
+    json::binder bind;
+    std::vector<log_record> records;
+
+    // parse to a tree, then copy every field into the structs
+    BENCHMARK("test json parse (copy out)")
+    {
+        json::json doc = json::json::from_view(text);
+        records.clear();
+        for (auto& elem : doc.parse()->get<json::node::arr_t>()) {
+            auto& obj = elem.get<json::node::obj_t>();
+            records.push_back({ obj.at("level").as<std::string>(), obj.at("message").as<std::string>(),
+                obj.at("agent").as<std::string>(), obj.at("path").as<std::string>() });
+        }
+        return records.size();
+    };
+
+    BENCHMARK("test bind read (structs)")
+    {
+        bind.read(text, records);
+        return records.size();
+    };
+
+    BENCHMARK("test bind write (structs)")
+    {
+        return bind.write(records).size();
+    };
+
+    std::string messages = make_telemetry(20000);
+    std::vector<telemetry> samples;
+
+    BENCHMARK("test bind read (shuffled)")
+    {
+        bind.read(messages, samples);
+        return samples.size();
+    };
+}
+
+TEST_CASE("snapshot test", "[benchmark]")
+{
+    std::string text = make_strings(20000);
+    std::string bytes = json::snapshot::from_json(text);
+
+    // load a document and read one record, as a service does at startup
+    BENCHMARK("test json load (strings)")
+    {
+        auto obj = json::json::from_view(text);
+        auto& rec = obj.parse()->get<json::node::arr_t>()[12345];
+        return rec.get<json::node::obj_t>().at("message").get<json::node::str_t>().size();
+    };
+
+    BENCHMARK("test snapshot load (strings)")
+    {
+        auto doc = json::snapshot::from_view(bytes);
+        return doc.root()[12345]["message"].as<std::string_view>().size();
+    };
+}
+
+TEST_CASE("ndjson test", "[benchmark]")
+{
+    std::string lines = make_lines(100000);
+    json::ndjson pool;
+
+    // scaling with the number of workers, up to one per core
+    for (std::size_t threads : { 1, 2, 4, 8 }) {
+        json::ndjson workers(threads);
+        BENCHMARK("test ndjson parse (" + std::to_string(threads) + " of " + std::to_string(pool.threads()) + " cores)")
+        {
+            std::size_t count = 0;
+            workers.parse(lines, [&count](json::node&) { ++count; });
+            return count;
+        };
+    }
+
+    std::string array = "[" + lines + "]";
+    std::replace(array.begin(), array.end() - 2, '\n', ',');
+    json::json sequential(array);
+    json::node got;
+
+    BENCHMARK("test json parse (array)")
+    {
+        return sequential.parse();
+    };
+
+    json::array_parser single(1);
+    json::array_parser split;
+
+    BENCHMARK("test array_parser parse (1 worker)")
+    {
+        return single.parse(array, got);
+    };
+
+    BENCHMARK("test array_parser parse (all cores)")
+    {
+        return split.parse(array, got);
+    };
+}
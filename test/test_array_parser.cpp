@@ -0,0 +1,61 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <mini_json/array_parser.hpp>
+#include <string>
+
+namespace json = mini_json;
+
+TEST_CASE("test array parser parse", "[array_parser]")
+{
+    // strings hide brackets, commas and escaped quotes from the split
+    std::string input = "[";
+    for (int i = 0; i < 40000; ++i) {
+        input += i ? ", " : " ";
+        input += i % 3 ? "{\"s\": \"a,]}\\\"[\", \"n\": [" + std::to_string(i) + ", {}]}" : std::to_string(i);
+    }
+    input += " ]\n";
+
+    json::json whole(input);
+    REQUIRE(whole.parse() != nullptr);
+
+    for (std::size_t threads : { 1, 4 }) {
+        json::array_parser parser(threads);
+        json::node got;
+        REQUIRE(parser.parse(input, got));
+        REQUIRE(got.get<json::node::arr_t>().size() == 40000);
+
+        // stringify through a json whose root is replaced
+        json::json again("0");
+        REQUIRE(again.parse() != nullptr);
+        *again.parse() = std::move(got);
+        REQUIRE(*again.str() == *whole.str());
+    }
+
+    json::array_parser parser(2);
+    json::node got;
+    REQUIRE(parser.parse(" [ ] ", got));
+    REQUIRE(got.get<json::node::arr_t>().empty());
+
+    // any other root is parsed as a whole
+    REQUIRE(parser.parse("{\"a\": [1]}", got));
+    REQUIRE(got.get<json::node::obj_t>().at("a").get<json::node::arr_t>().size() == 1);
+
+    REQUIRE(!parser.parse("[1, 2, ]", got));
+    REQUIRE(parser.errp() == json::json::error_code::expect_value);
+    REQUIRE(parser.errindex() == 2);
+
+    REQUIRE(!parser.parse("[1, [2}", got));
+    REQUIRE(parser.errp() == json::json::error_code::miss_separator);
+
+    REQUIRE(!parser.parse("[1, \"2]", got));
+    REQUIRE(parser.errp() == json::json::error_code::invalid_value);
+
+    REQUIRE(!parser.parse("[1] 2", got));
+    REQUIRE(parser.errp() == json::json::error_code::root_singular);
+
+    // a single worker parses the array as a whole, without an index
+    json::array_parser single(1);
+    REQUIRE(!single.parse("[1, 2, ]", got));
+    REQUIRE(single.errp() == json::json::error_code::invalid_value);
+    REQUIRE(single.errindex() == 0);
+}
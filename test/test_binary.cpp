@@ -0,0 +1,163 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mini_json/cbor.hpp>
+#include <mini_json/msgpack.hpp>
+#include <string>
+#include <string_view>
+
+namespace json = mini_json;
+
+static std::string bytes(std::string_view hex)
+{
+    std::string ret;
+    for (std::size_t i = 0; i + 1 < hex.size(); i += 3)
+        ret.push_back(static_cast<char>(std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+    return ret;
+}
+
+// a handler that stops at the first string
+struct stopper {
+    std::size_t events = 0;
+
+    bool null() { return ++events; }
+    bool boolean(bool) { return ++events; }
+    bool integer(json::node::int_t) { return ++events; }
+    bool uinteger(json::node::uint_t) { return ++events; }
+    bool number(json::node::num_t) { return ++events; }
+    bool key(std::string_view) { return ++events; }
+    bool string(std::string_view) { return false; }
+    bool start_object() { return ++events; }
+    bool end_object(std::size_t) { return ++events; }
+    bool start_array() { return ++events; }
+    bool end_array(std::size_t) { return ++events; }
+};
+
+static json::node decoded(json::cbor& codec, std::string const& hex)
+{
+    json::node ret;
+    REQUIRE(codec.decode(bytes(hex), ret));
+    return ret;
+}
+
+TEST_CASE("test msgpack", "[binary]")
+{
+    json::json doc("{\"a\": 1, \"b\": [true, null, -1, \"x\"], \"c\": [300, -33, 4294967296, 18446744073709551615, 1.5]}");
+    json::node& root = *doc.parse();
+
+    json::msgpack codec;
+    std::string packed = codec.encode(root);
+    REQUIRE(packed == bytes("83 a1 61 01 a1 62 94 c3 c0 ff a1 78 a1 63 95 cd 01 2c d0 df "
+                            "cf 00 00 00 01 00 00 00 00 cf ff ff ff ff ff ff ff ff cb 3f f8 00 00 00 00 00 00"));
+
+    json::node back;
+    REQUIRE(codec.decode(packed, back));
+    auto& obj = back.get<json::node::obj_t>();
+    REQUIRE(obj.at("a").get<json::node::int_t>() == 1);
+    REQUIRE(obj.at("b").get<json::node::arr_t>()[3].as<std::string>() == "x");
+    auto& nums = obj.at("c").get<json::node::arr_t>();
+    REQUIRE(nums[1].get<json::node::int_t>() == -33);
+    REQUIRE(nums[2].get<json::node::int_t>() == 4294967296);
+    REQUIRE(nums[3].get<json::node::uint_t>() == UINT64_MAX);
+    REQUIRE(nums[4].get<json::node::num_t>() == 1.5);
+    REQUIRE(codec.encode(back) == packed);
+
+    // the long forms of strings, arrays and maps
+    json::node big = json::node::arr_t(70000, json::node(std::string(300, 'y')));
+    REQUIRE(codec.decode(codec.encode(big), back));
+    REQUIRE(back.get<json::node::arr_t>().size() == 70000);
+    REQUIRE(back.get<json::node::arr_t>()[69999].as<std::string>() == std::string(300, 'y'));
+
+    json::node num;
+    REQUIRE(codec.decode(bytes("ca 3f c0 00 00"), num));
+    REQUIRE(num.get<json::node::num_t>() == 1.5);
+
+    REQUIRE(!codec.decode(bytes("92 01"), back));
+    REQUIRE(codec.errp() == json::json::error_code::expect_value);
+    REQUIRE(!codec.decode(bytes("a3 61 62"), back));
+    REQUIRE(codec.errp() == json::json::error_code::invalid_value);
+    REQUIRE(!codec.decode(bytes("81 01 02"), back));
+    REQUIRE(codec.errp() == json::json::error_code::invalid_key);
+    REQUIRE(!codec.decode(bytes("c1"), back));
+    REQUIRE(!codec.decode(bytes("01 02"), back));
+    REQUIRE(codec.errp() == json::json::error_code::root_singular);
+
+    stopper handler;
+    REQUIRE(!codec.decode(packed, handler));
+    REQUIRE(codec.errp() == json::json::error_code::aborted);
+    REQUIRE(handler.events == 8);
+}
+
+TEST_CASE("test cbor", "[binary]")
+{
+    json::cbor codec;
+
+    // the examples of rfc 8949
+    REQUIRE(decoded(codec, "17").get<json::node::int_t>() == 23);
+    REQUIRE(decoded(codec, "1b 00 00 00 e8 d4 a5 10 00").get<json::node::int_t>() == 1000000000000);
+    REQUIRE(decoded(codec, "1b ff ff ff ff ff ff ff ff").get<json::node::uint_t>() == UINT64_MAX);
+    REQUIRE(decoded(codec, "39 03 e7").get<json::node::int_t>() == -1000);
+    REQUIRE(decoded(codec, "3b ff ff ff ff ff ff ff ff").get<json::node::num_t>() == -18446744073709551616.0);
+    REQUIRE(decoded(codec, "f9 3e 00").get<json::node::num_t>() == 1.5);
+    REQUIRE(decoded(codec, "f9 7b ff").get<json::node::num_t>() == 65504.0);
+    REQUIRE(decoded(codec, "f9 00 01").get<json::node::num_t>() == 5.960464477539063e-8);
+    REQUIRE(decoded(codec, "f9 c4 00").get<json::node::num_t>() == -4.0);
+    REQUIRE(std::isinf(decoded(codec, "f9 7c 00").get<json::node::num_t>()));
+    REQUIRE(decoded(codec, "fa 47 c3 50 00").get<json::node::num_t>() == 100000.0);
+    REQUIRE(decoded(codec, "fb 3f f1 99 99 99 99 99 9a").get<json::node::num_t>() == 1.1);
+    REQUIRE(decoded(codec, "f7").as<std::nullptr_t>() == nullptr);
+    REQUIRE(decoded(codec, "c1 1a 51 4b 67 b0").get<json::node::int_t>() == 1363896240);
+    REQUIRE(decoded(codec, "64 49 45 54 46").as<std::string>() == "IETF");
+    REQUIRE(decoded(codec, "44 01 02 03 04").as<std::string>() == "\x01\x02\x03\x04");
+    REQUIRE(decoded(codec, "7f 65 73 74 72 65 61 64 6d 69 6e 67 ff").as<std::string>() == "streaming");
+
+    auto nested = decoded(codec, "9f 01 82 02 03 9f 04 05 ff ff");
+    REQUIRE(nested.get<json::node::arr_t>()[2].get<json::node::arr_t>()[1].as<int>() == 5);
+    auto map = decoded(codec, "bf 61 61 01 61 62 9f 02 03 ff ff");
+    REQUIRE(map.get<json::node::obj_t>().at("b").get<json::node::arr_t>().size() == 2);
+
+    json::json doc("{\"a\": 1, \"b\": [2, 3], \"c\": [-1, -1000, 1.1, false, null]}");
+    json::node& root = *doc.parse();
+    std::string packed = codec.encode(root);
+    REQUIRE(packed == bytes("a3 61 61 01 61 62 82 02 03 61 63 85 20 39 03 e7 fb 3f f1 99 99 99 99 99 9a f4 f6"));
+
+    json::node back;
+    REQUIRE(codec.decode(packed, back));
+    REQUIRE(codec.encode(back) == packed);
+
+    REQUIRE(!codec.decode(bytes("82 01"), back));
+    REQUIRE(codec.errp() == json::json::error_code::expect_value);
+    REQUIRE(!codec.decode(bytes("a1 01 02"), back));
+    REQUIRE(codec.errp() == json::json::error_code::invalid_key);
+    REQUIRE(!codec.decode(bytes("7f 61 61 41 62 ff"), back));
+    REQUIRE(!codec.decode(bytes("1c"), back));
+    REQUIRE(!codec.decode(bytes("ff"), back));
+    REQUIRE(codec.errp() == json::json::error_code::invalid_value);
+
+    stopper handler;
+    REQUIRE(!codec.decode(bytes("82 01 61 78"), handler));
+    REQUIRE(codec.errp() == json::json::error_code::aborted);
+    REQUIRE(handler.events == 2);
+}
+
+TEST_CASE("test binary round trip", "[binary]")
+{
+    std::ifstream fs("../test/demo/test2.json");
+    json::json doc(std::string { std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>() });
+    json::node& root = *doc.parse();
+
+    json::msgpack pack;
+    json::cbor cbor;
+    json::node from_pack, from_cbor;
+    REQUIRE(pack.decode(pack.encode(root), from_pack));
+    REQUIRE(cbor.decode(cbor.encode(root), from_cbor));
+
+    // both read back to the same tree, which writes the same text
+    std::string text = *doc.str();
+    root = std::move(from_pack);
+    REQUIRE(*doc.str() == text);
+    root = std::move(from_cbor);
+    REQUIRE(*doc.str() == text);
+}
@@ -0,0 +1,180 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mini_json/bind.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace json = mini_json;
+
+namespace app {
+
+struct user {
+    std::string name;
+    int age = 0;
+};
+
+struct record {
+    std::uint64_t id = 0;
+    bool active = false;
+    double score = 0;
+    std::optional<std::string> note;
+    user owner;
+    std::vector<user> friends;
+    std::map<std::string, int> counts;
+    std::vector<std::vector<int>> grid;
+};
+
+struct sample {
+    float x = 0;
+    double y = 0;
+};
+
+}; // namespace app
+
+MINI_JSON_BIND(app::user, name, age)
+MINI_JSON_BIND(app::record, id, active, score, note, owner, friends, counts, grid)
+MINI_JSON_BIND(app::sample, x, y)
+
+TEST_CASE("test bind read", "[bind]")
+{
+    json::binder bind;
+    app::record rec;
+
+    REQUIRE(bind.read("{\"grid\": [[1, 2], [], [3]], \"id\": 18446744073709551615, \"active\": true,"
+                      " \"unknown\": {\"deep\": [1, \"]\", {}]}, \"score\": -1.5e1, \"note\": null,"
+                      " \"owner\": {\"age\": 19, \"name\": \"arthur\\n\"},"
+                      " \"friends\": [{\"name\": \"ford\", \"age\": 2.0}, {\"name\": \"zaphod\"}],"
+                      " \"counts\": {\"a\": 1, \"b\\u0021\": -2}}",
+                      rec));
+
+    REQUIRE(rec.id == UINT64_MAX);
+    REQUIRE(rec.active);
+    REQUIRE(rec.score == -15.0);
+    REQUIRE_FALSE(rec.note);
+    REQUIRE(rec.owner.name == "arthur\n");
+    REQUIRE(rec.owner.age == 19);
+    REQUIRE(rec.friends.size() == 2);
+    REQUIRE(rec.friends[0].age == 2);
+    REQUIRE(rec.friends[1].name == "zaphod");
+    REQUIRE(rec.friends[1].age == 0);
+    REQUIRE(rec.counts.at("b!") == -2);
+    REQUIRE(rec.grid == std::vector<std::vector<int>> { { 1, 2 }, {}, { 3 } });
+
+    // an escaped key matches its member
+    REQUIRE(bind.read("{\"n\\u0061me\": \"x\", \"note\": \"y\"}", rec));
+    REQUIRE(rec.note == "y");
+
+    app::user one;
+    REQUIRE_FALSE(bind.read("{\"age\": 2147483648}", one));
+    REQUIRE(bind.errp() == json::json::error_code::invalid_value);
+    REQUIRE_FALSE(bind.read("{\"age\": \"19\"}", one));
+    REQUIRE(bind.errp() == json::json::error_code::invalid_value);
+    REQUIRE_FALSE(bind.read("{\"age\": 19 \"name\": \"\"}", one));
+    REQUIRE(bind.errp() == json::json::error_code::miss_separator);
+    REQUIRE_FALSE(bind.read("{\"name\": \"\\x\"}", one));
+    REQUIRE(bind.errp() == json::json::error_code::invalid_escape);
+    REQUIRE_FALSE(bind.read("{} {}", one));
+    REQUIRE(bind.errp() == json::json::error_code::root_singular);
+    REQUIRE_FALSE(bind.read("{\"other\": ", one));
+    REQUIRE(bind.errp() == json::json::error_code::expect_value);
+
+    std::unordered_map<std::string, std::vector<double>> series;
+    REQUIRE(bind.read(" {\"x\": [1, 2.5], \"y\": []} ", series));
+    REQUIRE(series.at("x")[1] == 2.5);
+
+    // a repeated key keeps its first value, like json does
+    REQUIRE(bind.read("{\"name\": \"a\", \"age\": 1, \"name\": \"b\", \"age\": [2]}", one));
+    REQUIRE(one.name == "a");
+    REQUIRE(one.age == 1);
+    REQUIRE(bind.read("{\"x\": [1], \"x\": [2, 3]}", series));
+    REQUIRE(series.at("x") == std::vector<double> { 1 });
+
+    // unknown values are checked, though not stored
+    REQUIRE(bind.read("{\"zz\": [true, false, null, -0.5e-3, \"\\u0021\", {\"a\": {}}], \"age\": 3}", one));
+    REQUIRE(one.age == 3);
+    REQUIRE_FALSE(bind.read("{\"zz\": tru}", one));
+    REQUIRE(bind.errp() == json::json::error_code::invalid_value);
+    REQUIRE_FALSE(bind.read("{\"zz\": truex}", one));
+    REQUIRE(bind.errp() == json::json::error_code::miss_separator);
+    REQUIRE_FALSE(bind.read("{\"zz\": [1, 01]}", one));
+    REQUIRE(bind.errp() == json::json::error_code::invalid_value);
+    REQUIRE_FALSE(bind.read("{\"zz\": -}", one));
+    REQUIRE(bind.errp() == json::json::error_code::invalid_value);
+    REQUIRE_FALSE(bind.read("{\"zz\": \"\\x\"}", one));
+    REQUIRE(bind.errp() == json::json::error_code::invalid_escape);
+    REQUIRE_FALSE(bind.read("{\"zz\": {\"a\" 1}}", one));
+    REQUIRE(bind.errp() == json::json::error_code::miss_separator);
+
+    // a float member only takes what fits in a float
+    app::sample num;
+    REQUIRE_FALSE(bind.read("{\"x\": 1e300}", num));
+    REQUIRE(bind.errp() == json::json::error_code::invalid_value);
+    REQUIRE_FALSE(bind.read("{\"x\": -3.5e38}", num));
+    REQUIRE(bind.errp() == json::json::error_code::invalid_value);
+    REQUIRE(bind.read("{\"x\": 3.4028235e38, \"y\": 1e300}", num));
+    REQUIRE(num.x == std::numeric_limits<float>::max());
+    REQUIRE(num.y == 1e300);
+}
+
+TEST_CASE("test bind write", "[bind]")
+{
+    app::record rec;
+    rec.id = 7;
+    rec.score = 0.5;
+    rec.note = "a\"b";
+    rec.owner = { "arthur", 19 };
+    rec.friends = { { "ford", 2 } };
+    rec.counts = { { "a", 1 }, { "b", 2 } };
+    rec.grid = { { 1 }, {} };
+
+    json::binder bind;
+    std::string text = bind.write(rec);
+    REQUIRE(text == "{\"id\": 7, \"active\": false, \"score\": 0.5, \"note\": \"a\\\"b\","
+                    " \"owner\": {\"name\": \"arthur\", \"age\": 19}, \"friends\": [{\"name\": \"ford\", \"age\": 2}],"
+                    " \"counts\": {\"a\": 1, \"b\": 2}, \"grid\": [[1], []]}");
+
+    // the output is valid json, and reads back to the same struct
+    json::json doc(text);
+    REQUIRE(doc.parse() != nullptr);
+    REQUIRE(*doc.str() == text);
+
+    app::record back;
+    REQUIRE(bind.read(text, back));
+    REQUIRE(bind.write(back) == text);
+
+    // a float is written in the shortest form that reads back as a float
+    app::sample num { 0.1f, 0.1 };
+    REQUIRE(bind.write(num) == "{\"x\": 0.1, \"y\": 0.1}");
+    num.x = std::numeric_limits<float>::max();
+    REQUIRE(bind.read(bind.write(num), num));
+    REQUIRE(num.x == std::numeric_limits<float>::max());
+}
+
+TEST_CASE("test key map", "[bind]")
+{
+    constexpr static std::string_view names[] = { "id", "name", "tags", "ids", "nam", "x", "", "user_id", "user_ip" };
+    constexpr static mini_mpf::key_map keys { names };
+
+    static_assert(keys.find("tags") == 2);
+    static_assert(keys.find("") == 6);
+    for (std::size_t i = 0; i < std::size(names); ++i)
+        REQUIRE(keys.find(names[i]) == i);
+
+    REQUIRE(keys.find("user_id_") == keys.npos);
+    REQUIRE(keys.find("user_iq") == keys.npos);
+    REQUIRE(keys.find("NAME") == keys.npos);
+    REQUIRE(keys.find(std::string_view("id\0", 3)) == keys.npos);
+
+    // keys that differ only in the middle
+    constexpr static std::string_view alike[] = { "xaaaaaaaaa", "axaaaaaaaa", "aaxaaaaaaa", "aaaxaaaaaa", "aaaaxaaaaa", "aaaaaxaaaa" };
+    constexpr static mini_mpf::key_map alike_keys { alike };
+    for (std::size_t i = 0; i < std::size(alike); ++i)
+        REQUIRE(alike_keys.find(alike[i]) == i);
+    REQUIRE(alike_keys.find("aaaaaaaaaa") == alike_keys.npos);
+}
@@ -1,6 +1,18 @@
 #include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
 #include <fstream>
+#include <memory>
+#include <sstream>
 #include <mini_json/json.hpp>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
 
 namespace json = mini_json;
 
@@ -20,4 +32,488 @@ TEST_CASE("test json initialize", "[json]")
     auto const& str = *sret;
     std::ofstream ofs("../test/demo/output.json");
     ofs << str;
-}
\ No newline at end of file
+}
+
+TEST_CASE("test json whitespace", "[json]")
+{
+    using Arr = json::node::arr_t;
+
+    // runs longer than one simd block, mixed with tabs and carriage returns
+    std::string pad(70, ' ');
+    json::json json_obj(pad + "[\r\n\t" + pad + "1," + pad + "\t\"a\"\n" + pad + "]" + pad);
+
+    auto ret = json_obj.parse();
+    REQUIRE(ret != nullptr);
+
+    auto const& arr = ret->get<Arr>();
+    REQUIRE(arr.size() == 2);
+    REQUIRE(arr[0].as<int>() == 1);
+    REQUIRE(arr[1].as<std::string_view>() == "a");
+
+    // parse can be repeated on the same context
+    REQUIRE(json_obj.parse() != nullptr);
+}
+
+TEST_CASE("test json string", "[json]")
+{
+    using Obj = json::node::obj_t;
+
+    std::string longer(100, 'x');
+    json::json json_obj("{\"plain\": \"" + longer + "\", \"esc\\nkey\": \"a\\\"b\\\\c\\/d\\t" + longer + "\\u00e9\"}");
+
+    auto ret = json_obj.parse();
+    REQUIRE(ret != nullptr);
+
+    auto const& obj = ret->get<Obj>();
+    REQUIRE(obj.at("plain").as<std::string>() == longer);
+    REQUIRE(obj.at("esc\nkey").as<std::string>() == "a\"b\\c/d\t" + longer + "\xC3\xA9");
+
+    json::json unterminated("[\"abc");
+    REQUIRE(unterminated.parse() == nullptr);
+    REQUIRE(unterminated.errp() == json::json::error_code::invalid_value);
+
+    json::json unquoted("{key: 1}");
+    REQUIRE(unquoted.parse() == nullptr);
+    REQUIRE(unquoted.errp() == json::json::error_code::invalid_key);
+}
+
+TEST_CASE("test json number", "[json]")
+{
+    auto parse = [](std::string src) {
+        json::json json_obj(std::move(src));
+        auto ret = json_obj.parse();
+        REQUIRE(ret != nullptr);
+        return ret->as<double>();
+    };
+
+    REQUIRE(parse("0") == 0.0);
+    REQUIRE(parse("-0") == 0.0);
+    REQUIRE(parse("19") == 19.0);
+    REQUIRE(parse("-1.5e3") == -1500.0);
+    REQUIRE(parse("1E-2") == 0.01);
+    REQUIRE(parse("0.1") == 0.1);
+    REQUIRE(parse("123e25") == 123e25);
+    REQUIRE(parse("0.30000000000000004") == 0.30000000000000004);
+    REQUIRE(parse("123456789012345678901234567890") == 123456789012345678901234567890.0);
+    REQUIRE(parse("2.2250738585072014e-308") == 2.2250738585072014e-308);
+    REQUIRE(parse("1.7976931348623157e308") == 1.7976931348623157e308);
+    REQUIRE(parse("4.9406564584124654e-324") == 4.9406564584124654e-324);
+    REQUIRE(parse("1e-400") == 0.0);
+
+    // forms accepted by strtod but not by json
+    for (auto bad : { "+1", "inf", "nan", "0x10", "01", "1.", ".5", "1e", "-", "1e400" }) {
+        json::json json_obj(bad);
+        REQUIRE(json_obj.parse() == nullptr);
+    }
+
+    json::json trailing("0x10");
+    REQUIRE(trailing.parse() == nullptr);
+    REQUIRE(trailing.errp() == json::json::error_code::root_singular);
+
+    // the decimal separator does not depend on the global locale
+    if (std::setlocale(LC_NUMERIC, "de_DE.UTF-8")) {
+        REQUIRE(parse("2.5") == 2.5);
+        std::setlocale(LC_NUMERIC, "C");
+    }
+}
+
+TEST_CASE("test json integer", "[json]")
+{
+    using Arr = json::node::arr_t;
+
+    json::json json_obj("[9007199254740993, -9223372036854775808, 18446744073709551615, 18446744073709551616, -0, 1.0]");
+    auto ret = json_obj.parse();
+    REQUIRE(ret != nullptr);
+
+    auto const& arr = ret->get<Arr>();
+    REQUIRE(arr[0].get<std::int64_t>() == 9007199254740993);
+    REQUIRE(arr[1].get<std::int64_t>() == INT64_MIN);
+    REQUIRE(arr[2].get<std::uint64_t>() == UINT64_MAX);
+    REQUIRE(arr[3].get<double>() == 18446744073709551616.0);
+    // -0 is kept as a double, so its sign is not lost
+    REQUIRE_THROWS_AS(arr[4].get<std::int64_t>(), json::bad_get);
+    REQUIRE(std::signbit(arr[4].get<double>()));
+    REQUIRE(arr[5].get<double>() == 1.0);
+
+    auto str = json_obj.str();
+    REQUIRE(str != nullptr);
+    REQUIRE(str->find("[9007199254740993, -9223372036854775808, 18446744073709551615, ") == 0);
+    REQUIRE(str->find(", -0, ") != std::string::npos);
+
+    json::json again(*str);
+    REQUIRE(again.parse() != nullptr);
+    REQUIRE(*again.str() == *str);
+}
+
+TEST_CASE("test json number stringify", "[json]")
+{
+    using Arr = json::node::arr_t;
+
+    json::json json_obj("[19.0, 0.1, 1.5e-7, 0.30000000000000004, 5e-324, 1.7976931348623157e308]");
+    REQUIRE(json_obj.parse() != nullptr);
+
+    auto str = json_obj.str();
+    REQUIRE(str != nullptr);
+    REQUIRE(*str == "[19, 0.1, 1.5e-07, 0.30000000000000004, 5e-324, 1.7976931348623157e+308]");
+
+    // the shortest form still reads back to the same values
+    json::json again(*str);
+    auto ret = again.parse();
+    REQUIRE(ret != nullptr);
+    REQUIRE(ret->get<Arr>()[3].as<double>() == 0.30000000000000004);
+    REQUIRE(ret->get<Arr>()[5].as<double>() == 1.7976931348623157e308);
+}
+
+TEST_CASE("test json string stringify", "[json]")
+{
+    using Arr = json::node::arr_t;
+
+    std::string longer(40, 'y');
+    json::json json_obj("[\"q\\\"b\\\\n\\nt\\tc\\u0001\\u001f" + longer + "\\u00e9\"]");
+    REQUIRE(json_obj.parse() != nullptr);
+
+    auto str = json_obj.str();
+    REQUIRE(str != nullptr);
+    REQUIRE(json_obj.str() == str);
+    REQUIRE(*str == "[\"q\\\"b\\\\n\\nt\\tc\\u0001\\u001f" + longer + "\xC3\xA9\"]");
+
+    // the output reads back to the same string
+    json::json again(*str);
+    auto ret = again.parse();
+    REQUIRE(ret != nullptr);
+    REQUIRE(ret->get<Arr>()[0].as<std::string>() == "q\"b\\n\nt\tc\x01\x1F" + longer + "\xC3\xA9");
+}
+
+TEST_CASE("test json arena", "[json]")
+{
+    std::ifstream fs("../test/demo/test2.json");
+    if (!fs.is_open())
+        throw std::runtime_error("can't open file");
+
+    std::string con { std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>() };
+
+    json::json heap(con);
+    json::json arena(con, { true });
+
+    auto hret = heap.parse();
+    auto aret = arena.parse();
+    REQUIRE(hret != nullptr);
+    REQUIRE(aret != nullptr);
+
+    // the tree lives in the arena, not in the default resource
+    auto const& arr = aret->get<json::node::arr_t>();
+    REQUIRE(arr.get_allocator().resource() != std::pmr::get_default_resource());
+    REQUIRE(*heap.str() == *arena.str());
+
+    // a copy leaves the arena, so it may outlive the json object
+    json::node copy = arr[0];
+    REQUIRE(copy.get<json::node::obj_t>().get_allocator().resource() == std::pmr::get_default_resource());
+
+    // reparsing releases the previous tree at once
+    REQUIRE(arena.parse() != nullptr);
+    REQUIRE(*heap.str() == *arena.str());
+}
+
+TEST_CASE("test json insitu", "[json]")
+{
+    using Arr = json::node::arr_t;
+
+    json::json json_obj("[\"plain\", \"esc\\taped\", {\"key\": \"value\"}]", { false, true });
+    auto ret = json_obj.parse();
+    REQUIRE(ret != nullptr);
+
+    // plain strings are views, escaped ones are materialized
+    auto const& arr = ret->get<Arr>();
+    REQUIRE(arr[0].get<std::string_view>() == "plain");
+    REQUIRE(arr[1].get<json::node::str_t>() == "esc\taped");
+    REQUIRE(arr[0].as<std::string>() == "plain");
+
+    // get<std::string_view> reads both kinds
+    REQUIRE(arr[1].get<std::string_view>() == "esc\taped");
+    REQUIRE(arr[2].get<json::node::obj_t>().at("key").get<std::string_view>() == "value");
+    REQUIRE_THROWS_AS(arr[2].get<std::string_view>(), json::bad_get);
+
+    // a copy owns its strings
+    json::node copy = arr[0];
+    REQUIRE(copy.get<json::node::str_t>() == "plain");
+
+    REQUIRE(*json_obj.str() == "[\"plain\", \"esc\\taped\", {\"key\": \"value\"}]");
+}
+
+TEST_CASE("test json intern", "[json]")
+{
+    using Arr = json::node::arr_t;
+    using Obj = json::node::obj_t;
+
+    std::string context = "[{\"id\": 1, \"user\": \"a\"}, {\"user\": \"b\", \"id\": 2}, {\"id\": 3}]";
+    json::json json_obj(context, { false, false, true });
+    auto ret = json_obj.parse();
+    REQUIRE(ret != nullptr);
+
+    // equal keys share one record of the pool
+    auto const& arr = ret->get<Arr>();
+    auto const& first = arr[0].get<Obj>();
+    auto const& second = arr[1].get<Obj>();
+    REQUIRE(first.begin()->first.interned());
+    REQUIRE(first.begin()->first == (second.begin() + 1)->first);
+    REQUIRE(first.begin()->first.view().data() == (second.begin() + 1)->first.view().data());
+    REQUIRE(second.at("id").as<int>() == 2);
+
+    // a copy owns its keys
+    json::node copy = arr[0];
+    REQUIRE(!copy.get<Obj>().begin()->first.interned());
+    REQUIRE(copy.get<Obj>().at("user").as<std::string>() == "a");
+
+    REQUIRE(*json_obj.str() == "[{\"id\": 1, \"user\": \"a\"}, {\"user\": \"b\", \"id\": 2}, {\"id\": 3}]");
+    REQUIRE(json_obj.parse() != nullptr);
+}
+
+// record every event as text, stop at the key given
+struct recorder {
+    std::string out;
+    std::string stop;
+
+    bool null()
+    {
+        out += "n ";
+        return true;
+    }
+
+    bool boolean(bool val)
+    {
+        out += val ? "t " : "f ";
+        return true;
+    }
+
+    bool integer(json::node::int_t val)
+    {
+        out += "i" + std::to_string(val) + " ";
+        return true;
+    }
+
+    bool uinteger(json::node::uint_t val)
+    {
+        out += "u" + std::to_string(val) + " ";
+        return true;
+    }
+
+    bool number(json::node::num_t val)
+    {
+        out += "d" + std::to_string(val) + " ";
+        return true;
+    }
+
+    bool string(std::string_view val)
+    {
+        out += "s" + std::string(val) + " ";
+        return true;
+    }
+
+    bool key(std::string_view val)
+    {
+        out += "k" + std::string(val) + " ";
+        return val != stop;
+    }
+
+    bool start_object()
+    {
+        out += "{ ";
+        return true;
+    }
+
+    bool end_object(std::size_t count)
+    {
+        out += "}" + std::to_string(count) + " ";
+        return true;
+    }
+
+    bool start_array()
+    {
+        out += "[ ";
+        return true;
+    }
+
+    bool end_array(std::size_t count)
+    {
+        out += "]" + std::to_string(count) + " ";
+        return true;
+    }
+};
+
+TEST_CASE("test json sax", "[json]")
+{
+    json::json json_obj("{\"a\": [null, true, false, -1, 18446744073709551615, 0.5], \"b\\n\": \"x\\ty\", \"c\": {}}");
+
+    recorder rec;
+    REQUIRE(json_obj.parse(rec));
+    REQUIRE(rec.out == "{ ka [ n t f i-1 u18446744073709551615 d0.500000 ]6 kb\n sx\ty kc { }0 }3 ");
+
+    // the handler may stop parsing at any event
+    recorder early;
+    early.stop = "b\n";
+    REQUIRE(!json_obj.parse(early));
+    REQUIRE(json_obj.errp() == json::json::error_code::aborted);
+    REQUIRE(early.out == "{ ka [ n t f i-1 u18446744073709551615 d0.500000 ]6 kb\n ");
+
+    json::json invalid("[1, 2");
+    recorder rest;
+    REQUIRE(!invalid.parse(rest));
+    REQUIRE(invalid.errp() == json::json::error_code::miss_separator);
+}
+
+TEST_CASE("test json builders", "[json]")
+{
+    // trees of any options and tapes are built from the same events
+    std::string context = "{\"a\": [1, {\"b\\n\": \"x\\ty\"}], \"a\": {\"c\": [2]}, \"d\": \"plain\", \"e\": -0.5}";
+    std::string want = "{\"a\": [1, {\"b\\n\": \"x\\ty\"}], \"d\": \"plain\", \"e\": -0.5}";
+
+    for (auto opt : { json::options {}, json::options { true, true, true } }) {
+        json::json json_obj(context, opt);
+        REQUIRE(json_obj.parse() != nullptr);
+        REQUIRE(*json_obj.str() == want);
+    }
+
+    json::json json_obj(context);
+    json::tape doc;
+    REQUIRE(json_obj.parse(doc));
+    REQUIRE(doc.root().size() == 4);
+
+    auto ret = json_obj.parse();
+    *ret = doc.root().to_node();
+    REQUIRE(*json_obj.str() == want);
+}
+
+TEST_CASE("test json from file", "[json]")
+{
+    std::ifstream fs("../test/demo/test2.json");
+    std::string con { std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>() };
+    json::json copied(std::move(con));
+    REQUIRE(copied.parse() != nullptr);
+
+    auto mapped = json::json::from_file("../test/demo/test2.json");
+    REQUIRE(mapped.parse() != nullptr);
+    REQUIRE(*mapped.str() == *copied.str());
+
+    // a file filling whole pages still ends with the padding
+    struct remove_file {
+        char const* path;
+        ~remove_file() { std::remove(path); }
+    } page_file { "../test/demo/page.json" };
+
+    std::string page = "[" + std::string(4094, ' ') + "]";
+    std::ofstream(page_file.path, std::ios::binary) << page;
+    auto aligned = json::json::from_file(page_file.path);
+    REQUIRE(aligned.parse() != nullptr);
+
+    REQUIRE_THROWS_AS(json::json::from_file("../test/demo/missing.json"), std::system_error);
+}
+
+TEST_CASE("test json view", "[json]")
+{
+    std::string context = "{\"a\": [1, -2.5e3, true, null, \"x\\u00e9\"], \"b\": {\"c\": \"d\"}}";
+
+    json::json whole(context);
+    REQUIRE(whole.parse() != nullptr);
+
+    // no prefix parses, and none is read past its end
+    for (std::size_t len = 0; len < context.size(); ++len) {
+        std::unique_ptr<char[]> buf(new char[len]);
+        std::copy(context.begin(), context.begin() + len, buf.get());
+
+        auto view = json::json::from_view(std::string_view(buf.get(), len));
+        REQUIRE(view.parse() == nullptr);
+
+        json::tape doc;
+        REQUIRE(!view.parse(doc));
+    }
+
+    // a view stops at its size, whatever follows in memory
+    std::string padded = context + "]]";
+    auto bounded = json::json::from_view(std::string_view(padded.data(), context.size()));
+    REQUIRE(bounded.parse() != nullptr);
+    REQUIRE(*bounded.str() == *whole.str());
+
+    auto truncated = json::json::from_view(std::string_view(padded.data(), 8));
+    REQUIRE(truncated.parse() == nullptr);
+    REQUIRE(truncated.errp() == json::json::error_code::miss_separator);
+
+    // literals with braced options still take the text as a whole
+    json::json literal("[1, 2]", {});
+    REQUIRE(literal.parse() != nullptr);
+    json::json literal_arena("[1, 2]", { true });
+    REQUIRE(literal_arena.parse() != nullptr);
+    REQUIRE(*literal_arena.str() == *literal.str());
+}
+
+TEST_CASE("test json write", "[json]")
+{
+    // large enough to flush the buffer of the writer many times
+    std::string context = "[";
+    for (int i = 0; i < 20000; ++i)
+        context += "{\"id\": " + std::to_string(i) + ", \"name\": \"n\\u00e9\\t" + std::to_string(i) + "\", \"ok\": true}, ";
+    context += "\"" + std::string(40000, 'z') + "\", -1.5]";
+
+    json::json json_obj(context);
+    REQUIRE(json_obj.parse() != nullptr);
+    std::string whole = *json_obj.str();
+
+    std::ostringstream os;
+    json::ostream_sink to_stream(os);
+    REQUIRE(json_obj.write(to_stream));
+    REQUIRE(os.str() == whole);
+
+    std::FILE* file = std::tmpfile();
+    json::fd_sink to_fd(fileno(file));
+    REQUIRE(json_obj.write(to_fd));
+    std::string read(whole.size() + 1, '\0');
+    std::rewind(file);
+    REQUIRE(std::fread(read.data(), 1, read.size(), file) == whole.size());
+    read.pop_back();
+    REQUIRE(read == whole);
+    std::fclose(file);
+
+    // the buffer tells the size it needs
+    std::string fixed(1000, '\0');
+    json::buffer_sink to_buffer(fixed.data(), fixed.size());
+    REQUIRE(json_obj.write(to_buffer));
+    REQUIRE(to_buffer.truncated());
+    REQUIRE(to_buffer.size() == whole.size());
+    REQUIRE(fixed == whole.substr(0, 1000));
+
+    // a failing sink stops the output
+    std::size_t blocks = 0;
+    json::callback_sink to_callback([&blocks](std::string_view) { return ++blocks < 3; });
+    REQUIRE(!json_obj.write(to_callback));
+    REQUIRE(json_obj.errs() == json::json::error_code::write_failed);
+    REQUIRE(blocks == 3);
+}
+
+TEST_CASE("test json str size", "[json]")
+{
+    std::string longer(40, 'y');
+    std::vector<std::string> contexts = {
+        "[]", "{}", "null", "[true, false, null]", "\"q\\\"b\\\\n\\nt\\tc\\u0001\\u001f" + longer + "\\u00e9\"",
+        "[0, -1, 9, 10, -10, 99, 100, -9223372036854775808, 18446744073709551615, 0.1, -1.5e-7, 1e300]",
+        "{\"a\": {\"b\": [1, {}, []], \"c\": \"\"}, \"\\n\": [\"\\u007f\"]}"
+    };
+
+    // the measured size is exactly the size written
+    for (auto& context : contexts) {
+        json::json json_obj(context);
+        REQUIRE(json_obj.parse() != nullptr);
+        std::size_t size = json_obj.str_size();
+        REQUIRE(json_obj.str()->size() == size);
+    }
+
+    std::ifstream fs("../test/demo/test2.json");
+    json::json demo(std::string { std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>() });
+    REQUIRE(demo.parse() != nullptr);
+    REQUIRE(demo.str()->size() == demo.str_size());
+
+    // a buffer of the measured size takes the whole output
+    std::string exact(demo.str_size(), '\0');
+    json::buffer_sink sink(exact.data(), exact.size());
+    REQUIRE(demo.write(sink));
+    REQUIRE(!sink.truncated());
+    REQUIRE(exact == *demo.str());
+}
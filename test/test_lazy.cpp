@@ -0,0 +1,89 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <mini_json/lazy.hpp>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace json = mini_json;
+
+TEST_CASE("test lazy navigate", "[lazy]")
+{
+    std::string input = R"( {"id": 42, "big": 18446744073709551615, "pi": 3.5,
+        "name": "mini", "esc": "a\"bA", "ok": true, "none": null,
+        "skip": {"deep": [1, {"x": "]}"}, "\\"]},
+        "tags": ["a", [], {}, -1], "k\"ey": 7} )";
+
+    json::lazy doc(input);
+    REQUIRE(doc.type() == json::node::data_k::object);
+    REQUIRE(doc.size() == 10);
+
+    REQUIRE(doc["id"].type() == json::node::data_k::integer);
+    REQUIRE(doc["id"].as<int>() == 42);
+    REQUIRE(doc["big"].type() == json::node::data_k::uinteger);
+    REQUIRE(doc["big"].as<json::node::uint_t>() == 18446744073709551615u);
+    REQUIRE(doc["pi"].as<double>() == 3.5);
+    REQUIRE(doc["name"].as<std::string_view>() == "mini");
+    REQUIRE(doc["esc"].as<std::string>() == "a\"bA");
+    REQUIRE_THROWS_AS(doc["esc"].as<std::string_view>(), json::bad_as);
+    REQUIRE(doc["ok"].as<bool>());
+    REQUIRE(doc["none"].type() == json::node::data_k::null);
+    REQUIRE(doc["none"].as<std::nullptr_t>() == nullptr);
+    REQUIRE_THROWS_AS(doc["none"].as<std::string_view>(), json::bad_as);
+    REQUIRE_THROWS_AS(doc["none"].as<std::string>(), json::bad_as);
+    REQUIRE(doc["k\"ey"].as<int>() == 7);
+
+    // brackets and quotes within skipped values do not end them early
+    REQUIRE(doc["skip"].raw() == R"({"deep": [1, {"x": "]}"}, "\\"]})");
+    REQUIRE(doc["skip"]["deep"][1]["x"].as<std::string>() == "]}");
+
+    auto tags = doc["tags"];
+    REQUIRE(tags.size() == 4);
+    REQUIRE(tags[1].size() == 0);
+    REQUIRE(tags[2].size() == 0);
+    REQUIRE(tags[3].as<int>() == -1);
+    REQUIRE_THROWS_AS(tags[4], std::out_of_range);
+
+    std::string keys;
+    for (auto it = doc.begin(); it != doc.end(); ++it)
+        keys += it.key() + ",";
+    REQUIRE(keys == "id,big,pi,name,esc,ok,none,skip,tags,k\"ey,");
+
+    REQUIRE(!doc.find("missing"));
+    REQUIRE_THROWS_AS(doc["missing"], std::out_of_range);
+    REQUIRE_THROWS_AS(doc["id"]["x"], json::bad_get);
+    REQUIRE_THROWS_AS(doc["name"].as<int>(), json::bad_as);
+
+    auto node = doc["skip"].to_node();
+    REQUIRE(node.get<json::node::obj_t>().at("deep").get<json::node::arr_t>().size() == 3);
+}
+
+TEST_CASE("test lazy invalid", "[lazy]")
+{
+    // only the parts that are read are checked
+    std::string input = R"({"good": [1, 2], "bad": [1 2 }, "late": tru})";
+    json::lazy doc(input);
+
+    REQUIRE(doc["good"][1].as<int>() == 2);
+    REQUIRE_THROWS_AS(doc["late"].as<bool>(), json::bad_parse);
+    REQUIRE_THROWS_AS(doc["bad"].size(), json::bad_parse);
+    REQUIRE_THROWS_AS(doc["bad"].to_node(), json::bad_parse);
+
+    REQUIRE_THROWS_AS(json::lazy(R"({"a": 1)")["b"], json::bad_parse);
+    REQUIRE_THROWS_AS(json::lazy(R"({"a" 1})")["a"], json::bad_parse);
+    REQUIRE_THROWS_AS(json::lazy(R"("open)").as<std::string>(), json::bad_parse);
+    REQUIRE_THROWS_AS(json::lazy("  ").type(), json::bad_parse);
+
+    // scalars are checked up to their end, not just by their start
+    REQUIRE_THROWS_AS(json::lazy("truex").as<bool>(), json::bad_parse);
+    REQUIRE_THROWS_AS(json::lazy("[12abc]")[0].as<int>(), json::bad_parse);
+    REQUIRE_THROWS_AS(json::lazy("nullnull").as<std::nullptr_t>(), json::bad_parse);
+    REQUIRE(json::lazy("[true, 12 ]")[1].as<int>() == 12);
+    REQUIRE(json::lazy("[false]")[0].as<bool>() == false);
+
+    // the end iterator cannot be moved past
+    json::lazy arr("[1]");
+    auto it = arr.begin();
+    REQUIRE(++it == arr.end());
+    REQUIRE_THROWS_AS(++it, json::bad_get);
+}
@@ -0,0 +1,74 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <mini_json/ndjson.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace json = mini_json;
+
+TEST_CASE("test ndjson parse", "[ndjson]")
+{
+    std::string input;
+    for (int i = 0; i < 5000; ++i) {
+        input += "{\"id\": " + std::to_string(i) + ", \"tags\": [\"a\", null]}\n";
+        if (i % 1000 == 0)
+            input += "  \r\n";
+    }
+
+    // the result does not depend on the number of workers
+    for (std::size_t threads : { 1, 3, 8 }) {
+        json::ndjson parser(threads);
+        std::vector<json::node> docs;
+        REQUIRE(parser.parse(input, docs));
+        REQUIRE(docs.size() == 5000);
+
+        bool ordered = true;
+        for (int i = 0; i < 5000; ++i)
+            ordered &= docs[i].get<json::node::obj_t>().at("id").as<int>() == i;
+        REQUIRE(ordered);
+    }
+}
+
+TEST_CASE("test ndjson error", "[ndjson]")
+{
+    std::string input;
+    for (int i = 0; i < 300; ++i)
+        input += i == 200 ? "{\"id\": }\n" : "[" + std::to_string(i) + "]\n";
+
+    json::ndjson parser(4);
+    std::size_t count = 0;
+    bool ordered = true;
+    REQUIRE(!parser.parse(input, [&](json::node& doc) {
+        ordered &= doc.get<json::node::arr_t>()[0].as<std::size_t>() == count++;
+    }));
+
+    // every document before the invalid one is handed over
+    REQUIRE(ordered);
+    REQUIRE(count == 200);
+    REQUIRE(parser.errline() == 200);
+    REQUIRE(parser.errp() == json::json::error_code::invalid_value);
+}
+
+TEST_CASE("test ndjson batches", "[ndjson]")
+{
+    std::size_t size = 3 * json::ndjson::batch_size;
+    std::string input;
+    for (std::size_t i = 0; i < size; ++i)
+        input += i == size / 2 ? "[}\n" : "[" + std::to_string(i) + "]\n";
+
+    // an invalid document in the middle batch stops the one after it
+    json::ndjson parser(4);
+    std::size_t count = 0;
+    REQUIRE(!parser.parse(input, [&](json::node&) { ++count; }));
+    REQUIRE(count == size / 2);
+    REQUIRE(parser.errline() == size / 2);
+
+    // so does a callback that throws, and the workers are reused after
+    REQUIRE_THROWS_AS(parser.parse(input, [](json::node&) { throw std::runtime_error("stop"); }), std::runtime_error);
+
+    std::vector<json::node> docs;
+    REQUIRE(parser.parse(input.substr(0, input.find("[}")), docs));
+    REQUIRE(docs.size() == size / 2);
+    REQUIRE(docs.back().get<json::node::arr_t>()[0].as<std::size_t>() == size / 2 - 1);
+}
@@ -1,9 +1,13 @@
 #include <catch2/catch_test_macros.hpp>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <stdexcept>
 #include <mini_json/node.hpp>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
@@ -43,6 +47,19 @@ TEST_CASE("test node number", "[node]")
     REQUIRE(num3.get<double>() == 1.0);
 }
 
+TEST_CASE("test node integer", "[node]")
+{
+    json::node int1(-7);
+    json::node int2(std::int64_t(9007199254740993));
+    json::node uint1(std::uint64_t(18446744073709551615u));
+
+    REQUIRE(int1.get<std::int64_t>() == -7);
+    REQUIRE(int1.as<double>() == -7.0);
+    REQUIRE(int2.as<std::int64_t>() == 9007199254740993);
+    REQUIRE(uint1.get<std::uint64_t>() == 18446744073709551615u);
+    REQUIRE_THROWS_AS(int1.get<double>(), json::bad_get);
+}
+
 TEST_CASE("test node string", "[node]")
 {
     std::string world = "world";
@@ -53,6 +70,25 @@ TEST_CASE("test node string", "[node]")
     REQUIRE(str1.get<std::string>() == "hello");
     REQUIRE(str2.as<std::string>() == "world");
     REQUIRE(str3.as<std::string_view>() == "world");
+
+    // get<std::string>() refers to the stored std::pmr::string
+    static_assert(std::is_same_v<decltype(str1.get<std::string>()), json::node::str_t&>);
+    str1.get<std::string>() += "!";
+    std::string copy = str1.as<std::string>();
+    REQUIRE(copy == "hello!");
+}
+
+TEST_CASE("test node move resource", "[node]")
+{
+    std::pmr::monotonic_buffer_resource pool;
+    json::node pooled(json::node::str_t("a string too long for the small buffer", &pool));
+    json::node plain(std::string("another string too long for the small buffer"));
+
+    // the moved-to node takes over the resource instead of copying into its own
+    pooled = std::move(plain);
+    REQUIRE(pooled.get<std::string>() == "another string too long for the small buffer");
+    REQUIRE(pooled.get<std::string>().get_allocator().resource() == std::pmr::get_default_resource());
+    REQUIRE(plain.as<std::nullptr_t>() == nullptr);
 }
 
 TEST_CASE("test node array", "[node]")
@@ -82,4 +118,68 @@ TEST_CASE("test node object", "[node]")
         REQUIRE(node["name"].get<std::string>() == "arthur");
         REQUIRE(node["age"].as<int>() == 19);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("test node object container", "[node]")
+{
+    using Obj = json::node::obj_t;
+
+    Obj obj;
+    obj.emplace("b", 1);
+    obj.emplace("a", 2);
+    REQUIRE(obj.emplace("b", 3).second == false);
+
+    // insertion order is kept and a repeated key keeps its first value
+    REQUIRE(obj.size() == 2);
+    REQUIRE(obj.begin()->first == "b");
+    REQUIRE(obj.at("b").as<int>() == 1);
+    REQUIRE(obj.count("c") == 0);
+    REQUIRE_THROWS_AS(obj.at("c"), std::out_of_range);
+
+    // past the threshold lookups go through the hash index
+    for (int i = 0; i < 100; ++i)
+        obj[std::to_string(i)] = i;
+
+    REQUIRE(obj.size() == 102);
+    for (int i = 0; i < 100; ++i)
+        REQUIRE(obj.at(std::to_string(i)).as<int>() == i);
+
+    REQUIRE(obj.erase("a") == 1);
+    REQUIRE(obj.erase("a") == 0);
+    REQUIRE(obj.find("a") == obj.end());
+    REQUIRE(obj.at("99").as<int>() == 99);
+    REQUIRE((obj.begin() + 1)->first == "0");
+
+    for (int i = 0; i < 95; ++i)
+        obj.erase(std::to_string(i));
+
+    REQUIRE(obj.size() == 6);
+    REQUIRE(obj.at("b").as<int>() == 1);
+    REQUIRE(obj.at("97").as<int>() == 97);
+}
+
+TEST_CASE("test node object keys", "[node]")
+{
+    using Obj = json::node::obj_t;
+
+    std::pmr::monotonic_buffer_resource pool;
+    Obj dst(&pool);
+    dst.emplace("a key too long to be stored inline", 1);
+
+    Obj src;
+    src.emplace("short", 2);
+    src.emplace("another key too long to be stored inline", 3);
+
+    // copied keys are made with the resource of the container they go to
+    dst = src;
+    REQUIRE(dst.size() == 2);
+    REQUIRE(dst.at("another key too long to be stored inline").as<int>() == 3);
+    for (auto& ent : dst)
+        REQUIRE(ent.first.get_allocator().resource() == &pool);
+
+    Obj moved(&pool);
+    moved = std::move(src);
+    REQUIRE((moved.begin() + 1)->first == "another key too long to be stored inline");
+    REQUIRE((moved.begin() + 1)->first.get_allocator().resource() == &pool);
+    REQUIRE(moved.begin()->first.size() == 5);
+}
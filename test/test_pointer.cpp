@@ -0,0 +1,112 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <mini_json/pointer.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json = mini_json;
+
+static std::string const input = R"({
+    "foo": ["bar", "baz"], "": 0, "a/b": 1, "c%d": 2, "m~n": 3, "k\"l": 6,
+    "routes": [{"host": "a", "port": 80}, {"host": "b", "port": 81}, {"host": "c"}],
+    "dup": {"x": 1}, "dup": {"y": 2}})";
+
+// the same document, with an invalid tail
+static std::string const broken = input.substr(0, input.size() - 1) + R"(, "tail": [})";
+
+TEST_CASE("test pointer compile", "[pointer]")
+{
+    REQUIRE(json::pointer("").path().empty());
+    REQUIRE(json::pointer("/").path().size() == 1);
+    REQUIRE(json::pointer("/a~1b/m~0n").path()[0].key == "a/b");
+    REQUIRE(json::pointer("/a~1b/m~0n").path()[1].key == "m~n");
+    REQUIRE(json::pointer("/foo/12").path()[1].index == 12);
+    REQUIRE(json::pointer("/foo/01").path()[1].index == json::pointer::npos);
+    REQUIRE(json::pointer("/foo/-").path()[1].index == json::pointer::npos);
+    REQUIRE(json::pointer("/*/host").wildcard());
+    REQUIRE(!json::pointer("/a*").wildcard());
+
+    REQUIRE_THROWS_AS(json::pointer("foo"), json::bad_pointer);
+    REQUIRE_THROWS_AS(json::pointer("/a~2"), json::bad_pointer);
+    REQUIRE_THROWS_AS(json::pointer("/a~"), json::bad_pointer);
+}
+
+TEST_CASE("test pointer find", "[pointer]")
+{
+    // the examples of rfc 6901, on the tree and on the text
+    auto doc = json::json::from_view(input);
+    json::node& root = *doc.parse();
+    json::lazy text(broken);
+
+    std::vector<std::pair<std::string, int>> cases = {
+        { "/", 0 }, { "/a~1b", 1 }, { "/c%d", 2 }, { "/m~0n", 3 }, { "/k\"l", 6 }
+    };
+    for (auto& [path, want] : cases) {
+        json::pointer ptr(path);
+        REQUIRE(ptr.find(root)->as<int>() == want);
+        REQUIRE(ptr.find(json::lazy(input))->as<int>() == want);
+    }
+
+    json::pointer baz("/foo/1");
+    REQUIRE(baz.find(root)->as<std::string>() == "baz");
+    REQUIRE(baz.find(json::lazy(input))->as<std::string_view>() == "baz");
+    REQUIRE(json::pointer("").find(root) == &root);
+
+    // a repeated key keeps its first value
+    REQUIRE(json::pointer("/dup/x").find(root));
+    REQUIRE(json::pointer("/dup/x").find(json::lazy(input)));
+    REQUIRE(!json::pointer("/dup/y").find(root));
+    REQUIRE(!json::pointer("/dup/y").find(json::lazy(input)));
+
+    for (auto path : { "/foo/2", "/foo/-", "/foo/bar", "/none", "/foo/0/x" }) {
+        REQUIRE(!json::pointer(path).find(root));
+        REQUIRE(!json::pointer(path).find(json::lazy(input)));
+    }
+
+    // a match is found before the invalid tail is read
+    REQUIRE(json::pointer("/routes/1/port").find(text)->as<int>() == 81);
+    REQUIRE_THROWS_AS(json::pointer("/missing").find(text), json::bad_parse);
+}
+
+TEST_CASE("test pointer wildcard", "[pointer]")
+{
+    auto doc = json::json::from_view(input);
+    json::node const& root = *doc.parse();
+    json::pointer hosts("/routes/*/host");
+
+    std::string seen;
+    hosts.select(root, [&seen](json::node const& got) { seen += got.as<std::string>(); });
+    hosts.select(json::lazy(input), [&seen](json::lazy got) { seen += got.as<std::string>(); });
+    REQUIRE(seen == "abcabc");
+
+    // returning false stops the search
+    std::size_t count = 0;
+    json::pointer("/routes/*/port").select(json::lazy(input), [&count](json::lazy) { return ++count < 1; });
+    REQUIRE(count == 1);
+}
+
+TEST_CASE("test query", "[pointer]")
+{
+    json::query routes { "/routes/1/host", "/m~0n", "/routes/0/port", "/routes/1/host/x" };
+    REQUIRE(routes.size() == 4);
+
+    // every target is settled before the invalid tail is read
+    std::vector<std::string> got(routes.size());
+    routes.run(json::lazy(broken), [&got](std::size_t which, json::lazy val) { got[which] = val.raw(); });
+    REQUIRE(got == std::vector<std::string> { "\"b\"", "3", "80", "" });
+
+    // a missing key is only known once the whole object was read
+    routes.add("/none");
+    REQUIRE_THROWS_AS(routes.run(json::lazy(broken), [](std::size_t, json::lazy) {}), json::bad_parse);
+
+    auto doc = json::json::from_view(input);
+    std::vector<std::size_t> seen;
+    routes.run(*doc.parse(), [&seen](std::size_t which, json::node&) { seen.push_back(which); });
+    REQUIRE(seen == std::vector<std::size_t> { 0, 1, 2 });
+
+    json::query all { "/routes/*/host", "/foo/0" };
+    std::size_t count = 0;
+    all.run(json::lazy(input), [&count](std::size_t, json::lazy) { ++count; });
+    REQUIRE(count == 4);
+}
@@ -0,0 +1,179 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <mini_json/push_parser.hpp>
+#include <string>
+#include <string_view>
+
+namespace json = mini_json;
+
+namespace {
+
+// write every event as text, so two parses can be compared
+struct printer {
+    std::string out;
+
+    bool null()
+    {
+        out += "n ";
+        return true;
+    }
+
+    bool boolean(bool val)
+    {
+        out += val ? "t " : "f ";
+        return true;
+    }
+
+    bool integer(json::node::int_t val)
+    {
+        out += "i" + std::to_string(val) + " ";
+        return true;
+    }
+
+    bool uinteger(json::node::uint_t val)
+    {
+        out += "u" + std::to_string(val) + " ";
+        return true;
+    }
+
+    bool number(json::node::num_t val)
+    {
+        out += "d" + std::to_string(val) + " ";
+        return true;
+    }
+
+    bool string(std::string_view val)
+    {
+        out += "s" + std::string(val) + " ";
+        return true;
+    }
+
+    bool key(std::string_view val)
+    {
+        out += "k" + std::string(val) + " ";
+        return val != "stop";
+    }
+
+    bool start_object()
+    {
+        out += "{ ";
+        return true;
+    }
+
+    bool end_object(std::size_t count)
+    {
+        out += "}" + std::to_string(count) + " ";
+        return true;
+    }
+
+    bool start_array()
+    {
+        out += "[ ";
+        return true;
+    }
+
+    bool end_array(std::size_t count)
+    {
+        out += "]" + std::to_string(count) + " ";
+        return true;
+    }
+};
+
+}; // namespace
+
+TEST_CASE("test push parser chunks", "[push_parser]")
+{
+    std::string context = "{\"name\": \"arthur\", \"esc\\\"key\": \"a\\\\b\\u00e9\\n\", "
+                          "\"nums\": [0, -12, 18446744073709551615, 1.5e-3, -0.25],"
+                          " \"lits\": [true, false, null], \"empty\": {}, \"nested\": [[], [{}]]}";
+
+    printer whole;
+    json::json json_obj(context);
+    REQUIRE(json_obj.parse(whole));
+
+    // every split point and chunk size gives the same events
+    for (std::size_t size = 1; size <= 7; ++size) {
+        printer got;
+        json::push_parser<printer> parser(got);
+        for (std::size_t pos = 0; pos < context.size(); pos += size)
+            REQUIRE(parser.feed(std::string_view(context).substr(pos, size)));
+        REQUIRE(parser.finish());
+        REQUIRE(got.out == whole.out);
+    }
+
+    for (std::size_t cut = 0; cut <= context.size(); ++cut) {
+        printer got;
+        json::push_parser<printer> parser(got);
+        REQUIRE(parser.feed(std::string_view(context).substr(0, cut)));
+        REQUIRE(parser.feed(std::string_view(context).substr(cut)));
+        REQUIRE(parser.finish());
+        REQUIRE(got.out == whole.out);
+    }
+}
+
+TEST_CASE("test push parser values", "[push_parser]")
+{
+    printer got;
+    json::push_parser<printer> parser(got);
+
+    // top-level values follow each other, a number ends with the input
+    REQUIRE(parser.feed("{\"a\": 1}\n[2"));
+    REQUIRE(got.out == "{ ka i1 }1 [ ");
+    REQUIRE(parser.depth() == 1);
+    REQUIRE(parser.feed("]\n3"));
+    REQUIRE(got.out == "{ ka i1 }1 [ i2 ]1 ");
+    REQUIRE(parser.finish());
+    REQUIRE(got.out == "{ ka i1 }1 [ i2 ]1 i3 ");
+
+    parser.reset();
+    REQUIRE(parser.feed("[1, 2"));
+    REQUIRE(!parser.finish());
+    REQUIRE(parser.errp() == json::json::error_code::expect_value);
+
+    parser.reset();
+    REQUIRE(!parser.feed("[1 2]"));
+    REQUIRE(parser.errp() == json::json::error_code::miss_separator);
+    REQUIRE(!parser.feed("3"));
+
+    parser.reset();
+    REQUIRE(parser.feed("[\"a\\"));
+    REQUIRE(!parser.feed("x\"]"));
+    REQUIRE(parser.errp() == json::json::error_code::invalid_escape);
+
+    parser.reset();
+    REQUIRE(!parser.feed("[nul]"));
+    REQUIRE(parser.errp() == json::json::error_code::invalid_value);
+
+    parser.reset();
+    REQUIRE(!parser.feed("{1: 2}"));
+    REQUIRE(parser.errp() == json::json::error_code::invalid_key);
+
+    parser.reset();
+    REQUIRE(!parser.feed("{\"a\": 1, \"stop\": 2}"));
+    REQUIRE(parser.errp() == json::json::error_code::aborted);
+
+    parser.reset();
+    REQUIRE(parser.feed("  "));
+    REQUIRE(!parser.finish());
+    REQUIRE(parser.errp() == json::json::error_code::expect_value);
+
+    // top-level values need whitespace between them, even across chunks
+    for (auto input : { "truefalse", "1true", "[1]2", "{}{}", "\"a\"\"b\"", "null[]" }) {
+        parser.reset();
+        REQUIRE(!parser.feed(input));
+        REQUIRE(parser.errp() == json::json::error_code::root_singular);
+    }
+
+    parser.reset();
+    REQUIRE(parser.feed("[1]"));
+    REQUIRE(!parser.feed("2"));
+    REQUIRE(parser.errp() == json::json::error_code::root_singular);
+
+    got.out.clear();
+    parser.reset();
+    REQUIRE(parser.feed("true false\t1\n[1]\r{} {}"));
+    REQUIRE(parser.feed(" \"a\""));
+    REQUIRE(parser.feed(" 2"));
+    REQUIRE(parser.finish());
+    REQUIRE(got.out == "t f i1 [ i1 ]1 { }0 { }0 sa i2 ");
+}
@@ -0,0 +1,113 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mini_json/snapshot.hpp>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace json = mini_json;
+
+TEST_CASE("test snapshot navigate", "[snapshot]")
+{
+    auto bytes = json::snapshot::from_json("{\"name\": \"arthur\", \"age\": -19, \"id\": 18446744073709551615,"
+                                           " \"big\": -9223372036854775807, \"tags\": [true, null, 1.5, \"arthur\"],"
+                                           " \"empty\": {}}");
+    json::snapshot doc(bytes);
+
+    auto root = doc.root();
+    REQUIRE(root.type() == json::node::data_k::object);
+    REQUIRE(root.size() == 6);
+    REQUIRE(root["name"].as<std::string_view>() == "arthur");
+    REQUIRE(root["age"].as<int>() == -19);
+    REQUIRE(root["id"].as<std::uint64_t>() == UINT64_MAX);
+    REQUIRE(root["big"].as<std::int64_t>() == -9223372036854775807);
+    REQUIRE(root["empty"].size() == 0);
+    REQUIRE_FALSE(root.find("missing"));
+    REQUIRE_THROWS_AS(root["missing"], std::out_of_range);
+
+    auto tags = root["tags"];
+    REQUIRE(tags.size() == 4);
+    REQUIRE(tags[0].as<bool>() == true);
+    REQUIRE(tags[1].type() == json::node::data_k::null);
+    REQUIRE(tags[1].as<std::nullptr_t>() == nullptr);
+    REQUIRE_THROWS_AS(tags[1].as<std::string_view>(), json::bad_as);
+    REQUIRE(tags[2].as<double>() == 1.5);
+    REQUIRE(tags[3].as<std::string>() == "arthur");
+    REQUIRE_THROWS_AS(tags[3].as<int>(), json::bad_as);
+    REQUIRE_THROWS_AS(tags[4], std::out_of_range);
+
+    // equal strings share one copy
+    REQUIRE(tags[3].as<std::string_view>().data() == root["name"].as<std::string_view>().data());
+
+    // members come back sorted by key
+    std::string keys;
+    for (auto it = root.begin(); it != root.end(); ++it)
+        keys += it.key();
+    REQUIRE(keys == "agebigemptyidnametags");
+
+    // a view of the same bytes reads the same values
+    auto other = json::snapshot::from_view(doc.data());
+    REQUIRE(other.root()["tags"][2].as<double>() == 1.5);
+}
+
+TEST_CASE("test snapshot invalid", "[snapshot]")
+{
+    REQUIRE_THROWS_AS(json::snapshot(std::string("mjsn")), json::bad_snapshot);
+    REQUIRE_THROWS_AS(json::snapshot::from_json("[1, 2"), json::bad_parse);
+
+    auto bytes = json::snapshot::from_json("[[1], \"ab\"]");
+    auto bad_magic = bytes;
+    bad_magic[0] = 'x';
+    REQUIRE_THROWS_AS(json::snapshot(bad_magic), json::bad_snapshot);
+
+    // an offset past the end is caught when it is read
+    auto bad_offset = bytes;
+    json::detail::store_le(bad_offset.data() + 32, std::uint64_t(0x5B) << 56 | 4096);
+    json::snapshot doc(bad_offset);
+    REQUIRE_THROWS_AS(doc.root()[0].size(), json::bad_snapshot);
+    REQUIRE_THROWS_AS(doc.root().to_node(), json::bad_snapshot);
+
+    // so is a container that points back to its parent
+    auto cycle = bytes;
+    json::detail::store_le(cycle.data() + 32, std::uint64_t(0x5B) << 56 | 24);
+    REQUIRE_THROWS_AS(json::snapshot(cycle).root().to_node(), json::bad_snapshot);
+}
+
+TEST_CASE("test snapshot file", "[snapshot]")
+{
+    std::ifstream fs("../test/demo/test2.json");
+    if (!fs.is_open())
+        throw std::runtime_error("can't open file");
+
+    std::string con { std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>() };
+
+    struct remove_file {
+        char const* path;
+        ~remove_file() { std::remove(path); }
+    } snap_file { "../test/demo/test2.snap" };
+
+    {
+        std::ofstream os(snap_file.path, std::ios::binary);
+        json::ostream_sink sink(os);
+        json::json tree(con);
+        REQUIRE(json::snapshot::write(*tree.parse(), sink));
+    }
+
+    auto doc = json::snapshot::from_file(snap_file.path);
+
+    // every member is found by its key
+    json::json tree(con);
+    auto const& arr = tree.parse()->get<json::node::arr_t>();
+    auto root = doc.root();
+    REQUIRE(root.size() == arr.size());
+
+    for (std::size_t i = 0; i < arr.size(); ++i)
+        for (auto& ent : arr[i].get<json::node::obj_t>())
+            REQUIRE(root[i].find(std::string_view(ent.first)));
+
+    // the materialized tree is already in key order, so it encodes the same
+    REQUIRE(json::snapshot::encode(root.to_node()) == doc.data());
+}
@@ -0,0 +1,85 @@
+#include <catch2/catch_test_macros.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mini_json/json.hpp>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace json = mini_json;
+
+TEST_CASE("test tape navigate", "[tape]")
+{
+    json::json json_obj("{\"name\": \"arthur\", \"age\": 19, \"id\": 18446744073709551615,"
+                        " \"tags\": [true, null, 1.5, \"a\\nb\"], \"empty\": {}}");
+    json::tape doc;
+    REQUIRE(json_obj.parse(doc));
+
+    auto root = doc.root();
+    REQUIRE(root.type() == json::node::data_k::object);
+    REQUIRE(root.size() == 5);
+    REQUIRE(root["name"].as<std::string_view>() == "arthur");
+    REQUIRE(root["age"].as<int>() == 19);
+    REQUIRE(root["id"].as<std::uint64_t>() == UINT64_MAX);
+    REQUIRE(root["empty"].size() == 0);
+    REQUIRE_FALSE(root.find("missing"));
+    REQUIRE_THROWS_AS(root["missing"], std::out_of_range);
+
+    auto tags = root["tags"];
+    REQUIRE(tags.size() == 4);
+    REQUIRE(tags[0].as<bool>() == true);
+    REQUIRE(tags[1].type() == json::node::data_k::null);
+    REQUIRE(tags[1].as<std::nullptr_t>() == nullptr);
+    REQUIRE_THROWS_AS(tags[1].as<std::string_view>(), json::bad_as);
+    REQUIRE(tags[2].as<double>() == 1.5);
+    REQUIRE(tags[3].as<std::string>() == "a\nb");
+    REQUIRE_THROWS_AS(tags[3].as<int>(), json::bad_as);
+
+    std::string keys;
+    for (auto it = root.begin(); it != root.end(); ++it)
+        keys += it.key();
+    REQUIRE(keys == "nameageidtagsempty");
+}
+
+TEST_CASE("test tape to node", "[tape]")
+{
+    std::ifstream fs("../test/demo/test2.json");
+    if (!fs.is_open())
+        throw std::runtime_error("can't open file");
+
+    std::string con { std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>() };
+
+    json::json json_obj(con);
+    json::tape doc;
+    REQUIRE(json_obj.parse(doc));
+
+    json::json tree(con);
+    auto ret = tree.parse();
+    REQUIRE(ret != nullptr);
+
+    // a materialized tape holds the same values as a parsed tree
+    auto from_tape = doc.root().to_node();
+    auto const& lhs = from_tape.get<json::node::arr_t>();
+    auto const& rhs = ret->get<json::node::arr_t>();
+    REQUIRE(lhs.size() == rhs.size());
+    REQUIRE(doc.root().size() == rhs.size());
+
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        auto const& lobj = lhs[i].get<json::node::obj_t>();
+        auto const& robj = rhs[i].get<json::node::obj_t>();
+        REQUIRE(lobj.size() == robj.size());
+        for (auto const& [key, val] : robj)
+            REQUIRE(lobj.count(key) == 1);
+    }
+
+    // and every value is the same, so both write the same text
+    std::string text = *tree.str();
+    *ret = std::move(from_tape);
+    REQUIRE(*tree.str() == text);
+
+    json::json broken("[1 2]");
+    REQUIRE_FALSE(broken.parse(doc));
+    REQUIRE(broken.errp() == json::json::error_code::miss_separator);
+    REQUIRE(doc.empty());
+}